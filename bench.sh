@@ -0,0 +1,37 @@
+#!/bin/bash
+# Run the benchmark configurations with fixed seeds. Every run appends one
+# JSON record (events/s, steps/event, peak RSS, output bytes/event, and the
+# configuration) to $RESULTS. Compare the records of two builds, e.g.
+#   RESULTS=new.jsonl ./bench.sh
+#
+#   EVENTS  : events per configuration (default 100000)
+#   THREADS : worker threads (default 1)
+#   TOYMC   : executable (default ./toyMC_batch)
+#   PHYSICS : further physics lists to run bench_geometry.mac with, e.g.
+#             "QGSP_BIC_HP FTFP_BERT_HP" (default none, QBBC only)
+
+EVENTS=${EVENTS:-100000}
+THREADS=${THREADS:-1}
+TOYMC=${TOYMC:-./toyMC_batch}
+RESULTS=${RESULTS:-bench/results.jsonl}
+mkdir -p bench
+
+run() {
+  name=$1
+  shift
+  echo "$name"
+  $TOYMC -t $THREADS --seed 1 --events $EVENTS --bench $RESULTS "$@" \
+    bench/$name > bench/$name.log || echo "$name failed, see bench/$name.log"
+}
+
+run source           bench_source.mac
+run geometry         bench_geometry.mac
+run geometry_placed  --geometry placed bench_geometry.mac
+run detector_step    --output step  bench_detector.mac
+run detector_track   --output track bench_detector.mac
+run detector_event   --output event bench_detector.mac
+for list in $PHYSICS; do
+  run geometry_$list --physics-list $list bench_geometry.mac
+done
+
+echo "Results in $RESULTS"
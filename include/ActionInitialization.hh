@@ -5,6 +5,7 @@
 #define ActionInitialization_h 1
 #include "G4String.hh"
 #include "G4VUserActionInitialization.hh"
+#include "RunAction.hh"
 
 /// Action initialization class.
 
@@ -20,8 +21,25 @@ class ActionInitialization : public G4VUserActionInitialization
     {
       m_hDataFilename = hFilename;
     }
+    void SetOutputMode(OutputMode mode) { fOutputMode = mode; }
+    void SetShard(G4int shard) { fShard = shard; }
+    void SetCheckpointInterval(G4int nEvents) { fCheckpointInterval = nEvents; }
+    void SetBenchmark(const G4String& fileName, const G4String& name)
+    {
+      fBenchFile = fileName;
+      fBenchName = name;
+    }
+    void SetPhysicsListName(const G4String& name) { fPhysicsListName = name; }
   private:
+    void ConfigureRunAction(RunAction* runAction) const;
+
     G4String m_hDataFilename = "ac.root"; //default out file
+    OutputMode fOutputMode = OutputMode::Step;
+    G4int fShard = 0;
+    G4int fCheckpointInterval = 0;
+    G4String fBenchFile;
+    G4String fBenchName;
+    G4String fPhysicsListName;
 };
 
 #endif
@@ -0,0 +1,45 @@
+/// \file AliasTable.hh
+/// \brief Definition of the AliasTable class
+
+#ifndef AliasTable_h
+#define AliasTable_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Walker alias table: samples an index of a discrete distribution in
+/// constant time, with one uniform number, whatever the number of bins.
+/// Built with Vose's method from non-negative weights.
+
+class AliasTable
+{
+  public:
+    AliasTable() = default;
+    explicit AliasTable(const std::vector<G4double>& weights)
+      { Build(weights); }
+
+    void Build(const std::vector<G4double>& weights);
+
+    /// Index for a uniform number u in [0,1)
+    size_t Sample(G4double u) const
+    {
+      G4double x = u*fProbability.size();
+      size_t i = (size_t) x;
+      if (i >= fProbability.size()) i = fProbability.size() - 1;
+      return (x - i) < fProbability[i] ? i : fAlias[i];
+    }
+
+    /// Normalised probability of an index
+    G4double Probability(size_t i) const { return fPdf[i]; }
+    size_t Size() const { return fPdf.size(); }
+
+  private:
+    std::vector<G4double> fProbability;
+    std::vector<size_t>   fAlias;
+    std::vector<G4double> fPdf;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,43 @@
+/// \file CheckpointManager.hh
+/// \brief Definition of the CheckpointManager class
+
+#ifndef CheckpointManager_h
+#define CheckpointManager_h 1
+
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Checkpoint and resume of long runs: /toy/run/beamOn replaces
+/// /run/beamOn in the macros.
+///
+/// Without a checkpoint interval it is a plain beamOn. With an interval of
+/// N events (toyMC --checkpoint N) the events are run as segments of N,
+/// one Geant4 run each, whose ntuples RunAction writes and closes into
+/// <output>_seg<k>.root. After every segment the number of segments done
+/// and the state of the master random engine (which seeds the workers)
+/// are saved to <output>.ckpt. A job started again with the same command
+/// line restores the engine and continues with the next segment, giving
+/// the same events as an uninterrupted job; a half-written segment is
+/// simply run again.
+
+class CheckpointManager
+{
+  public:
+    CheckpointManager(const G4String& fileName, G4int interval);
+    ~CheckpointManager();
+
+    void BeamOn(G4int nEvents);
+
+  private:
+    G4int Restore(G4int nEvents);
+    void Save(G4int nEvents, G4int nSegmentsDone);
+
+    G4GenericMessenger* fMessenger;
+    G4String fFileName;
+    G4int    fInterval;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
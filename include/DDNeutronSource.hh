@@ -0,0 +1,71 @@
+/// \file DDNeutronSource.hh
+/// \brief Definition of the DDNeutronSource class
+
+#ifndef DDNeutronSource_h
+#define DDNeutronSource_h 1
+
+#include "AliasTable.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+/// D(d,n)3He neutron point source with the energy correlated to the
+/// emission angle, configured with the /toy/dd/ commands.
+///
+/// The table file (e.g. dd_source.dat) gives yields in bins of the angle
+/// to the deuteron beam axis and of the energy. The angle bin is sampled
+/// from an alias table of the bin yields, the direction uniformly in the
+/// solid angle of the bin and around the axis, and the energy from the
+/// alias table of that angle bin, uniformly within the energy bin: O(1)
+/// per primary, the sampled bin is handed on to SampleEnergy(). For a
+/// direction chosen elsewhere (source biasing) FindBin() looks the bin up
+/// by binary search, AngularDensity() gives the density the bias weight is
+/// computed from and the energy is sampled in that bin.
+/// Angles which no bin of the table covers have density 0: the source
+/// emits nothing there.
+
+class DDNeutronSource
+{
+  public:
+    DDNeutronSource();
+    ~DDNeutronSource();
+
+    G4bool IsActive() const { return !fAngleBins.empty(); }
+    const G4ThreeVector& GetPosition() const { return fPosition; }
+
+    /// angleBin: the bin the direction was sampled in
+    G4ThreeVector SampleDirection(size_t& angleBin) const;
+    /// The angle bin of a direction, NoBin() if no bin covers its angle
+    size_t FindBin(const G4ThreeVector& direction) const;
+    size_t NoBin() const { return fAngleBins.size(); }
+    /// Only for a bin, not NoBin()
+    G4double SampleEnergy(size_t angleBin) const;
+    /// Probability per unit solid angle of the directions in a bin, 0 for
+    /// NoBin()
+    G4double AngularDensity(size_t angleBin) const;
+
+    void LoadTable(const G4String& fileName);
+
+  private:
+    struct AngleBin {
+      G4double cosLow;   // cos of the upper angle edge
+      G4double cosHigh;  // cos of the lower angle edge
+      std::vector<G4double> eLow, eHigh;
+      AliasTable energy;
+    };
+
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4ThreeVector fPosition;
+    G4ThreeVector fBeamAxis;
+    std::vector<AngleBin> fAngleBins;  // in increasing angle
+    AliasTable fAngle;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -33,11 +33,27 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
 #include "G4NistManager.hh"
+#include "G4ThreeVector.hh"
 
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4GenericMessenger;
+
+/// Construction of the air region:
+/// Boolean - AirTee, a G4UnionSolid of the air box and the pipe bores,
+///           with G4SubtractionSolid steel pipes (default)
+/// Placed  - the same setup from placed boxes and tubes with air daughters
+enum class GeometryMode { Boolean, Placed };
 
 /// Detector construction class to define materials and geometry.
+///
+/// The /toy/det/ commands change the Scintillator material, the offset of
+/// the beam pipe with DetectorTub and the angle of the guide pipe. Between
+/// runs they reinitialise the geometry only: the next run rebuilds it and
+/// keeps the physics tables, computing tables only for new materials. Once
+/// a command was used, every output file is tagged with the configuration
+/// (see GetConfigurationTag), so that a macro can scan configurations in
+/// one process.
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -46,11 +62,52 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     virtual ~DetectorConstruction();
 
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField();
     void DefineMaterial();
+    void SetGeometryMode(GeometryMode mode) { fGeometryMode = mode; }
+    // Production runs: read the geometry (with its materials) from a GDML
+    // file written by ExportGdml() instead of building it
+    void SetGdmlFile(const G4String& fileName) { fGdmlFile = fileName; }
+    void SetCheckOverlaps(G4bool check) { fCheckOverlaps = check; }
+    /// Attach a forced-collision operator to the Scintillator in
+    /// ConstructSDandField (see ScintillatorBiasing)
+    void SetForceCollision(G4bool force) { fForceCollision = force; }
+    /// "gdml", "boolean" or "placed", for reports
+    G4String GetGeometryName() const
+    {
+      if (!fGdmlFile.empty()) return "gdml";
+      return fGeometryMode == GeometryMode::Placed ? "placed" : "boolean";
+    }
+    // Build the geometry with overlap checks and write it to a GDML file
+    void ExportGdml(const G4String& fileName);
+
+    void SetScintillatorMaterial(const G4String& name);
+    void SetDetectorOffset(G4double offset);
+    void SetGuidePipeAngle(G4double angle);
+    /// Whether a /toy/det/ command changed the configuration
+    G4bool IsModified() const { return fModified; }
+    /// e.g. "HeavyWater_45deg_45.72mm": material, guide pipe angle and
+    /// detector offset
+    G4String GetConfigurationTag() const;
     //G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
     
   protected:
+    void GeometryModified();
+    void DefineCommands();
+    void ConstructPlaced(G4LogicalVolume* logicEnv, G4bool checkOverlaps);
+    void PlaceScintillator(G4LogicalVolume* mother, const G4ThreeVector& pos,
+                           G4bool checkOverlaps);
+
     G4LogicalVolume*  fScoringVolume;
+    GeometryMode      fGeometryMode;
+    G4String          fGdmlFile;
+    G4bool            fCheckOverlaps;
+    G4bool            fForceCollision;
+    G4GenericMessenger* fMessenger;
+    G4String          fScintillatorMaterial;
+    G4double          fDetectorOffset;
+    G4double          fGuidePipeAngle;
+    G4bool            fModified;
     G4Material *Air,*Water,*EJ276,*EJ315,*SS304LSteel,*C6D8,*HeavyWater;
 };
 
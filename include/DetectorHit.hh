@@ -0,0 +1,104 @@
+/// \file DetectorHit.hh
+/// \brief Definition of the DetectorHit class
+
+#ifndef DetectorHit_h
+#define DetectorHit_h 1
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "G4ThreeVector.hh"
+#include "tls.hh"
+
+class G4ParticleDefinition;
+
+/// Detector hit class
+///
+/// One hit per step of any track in a sensitive volume (DetectorTub or
+/// Scintillator). It keeps the quantities of the former step ntuple:
+/// kinetic energy at the pre-step point, pre- and post-step positions,
+/// energy deposit, particle and track/parent IDs, and whether the step
+/// ended in an interaction (a discrete process rather than a boundary),
+/// and the statistical weight of the track.
+
+class DetectorHit : public G4VHit
+{
+  public:
+    DetectorHit();
+    DetectorHit(const DetectorHit&);
+    virtual ~DetectorHit();
+
+    // operators
+    const DetectorHit& operator=(const DetectorHit&);
+    G4bool operator==(const DetectorHit&) const;
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    // methods from base class
+    virtual void Draw();
+    virtual void Print();
+
+    // Set methods
+    void SetTrackID  (G4int track)      { fTrackID = track; };
+    void SetParentID (G4int parent)     { fParentID = parent; };
+    void SetParticle (const G4ParticleDefinition* particle)
+                                        { fParticle = particle; };
+    void SetEnergy   (G4double energy)  { fEnergy = energy; };
+    void SetEdep     (G4double de)      { fEdep = de; };
+    void SetTime     (G4double time)    { fTime = time; };
+    void SetPrePos   (G4ThreeVector xyz){ fPrePos = xyz; };
+    void SetPostPos  (G4ThreeVector xyz){ fPostPos = xyz; };
+    void SetInteraction(G4bool flag)    { fInteraction = flag; };
+    void SetWeight   (G4double weight)  { fWeight = weight; };
+
+    // Get methods
+    G4int GetTrackID() const     { return fTrackID; };
+    G4int GetParentID() const    { return fParentID; };
+    const G4ParticleDefinition* GetParticle() const { return fParticle; };
+    G4double GetEnergy() const   { return fEnergy; };
+    G4double GetEdep() const     { return fEdep; };
+    G4double GetTime() const     { return fTime; };
+    G4ThreeVector GetPrePos() const  { return fPrePos; };
+    G4ThreeVector GetPostPos() const { return fPostPos; };
+    G4bool IsInteraction() const { return fInteraction; };
+    G4double GetWeight() const   { return fWeight; };
+
+  private:
+    G4int         fTrackID;
+    G4int         fParentID;
+    const G4ParticleDefinition* fParticle;
+    G4double      fEnergy;
+    G4double      fEdep;
+    G4double      fTime;
+    G4ThreeVector fPrePos;
+    G4ThreeVector fPostPos;
+    G4bool        fInteraction;
+    G4double      fWeight;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+typedef G4THitsCollection<DetectorHit> DetectorHitsCollection;
+
+extern G4ThreadLocal G4Allocator<DetectorHit>* DetectorHitAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* DetectorHit::operator new(size_t)
+{
+  if(!DetectorHitAllocator)
+      DetectorHitAllocator = new G4Allocator<DetectorHit>;
+  return (void *) DetectorHitAllocator->MallocSingle();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DetectorHit::operator delete(void *hit)
+{
+  DetectorHitAllocator->FreeSingle((DetectorHit*) hit);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,58 @@
+/// \file DetectorRegions.hh
+/// \brief Definition of the DetectorRegions class
+
+#ifndef DetectorRegions_h
+#define DetectorRegions_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4VModularPhysicsList;
+class G4GenericMessenger;
+
+/// Named regions of the setup, with their own production cuts and user
+/// limits, configured with the /toy/region/ commands:
+///   Tank     - the Envelope water tank
+///   Pipes    - the SS304LSteel guide and beam pipes
+///   AirTee   - the air volume (AirTee, or Container and the pipe bores)
+///   Detector - the Scintillator and DetectorTub
+/// Everything else (the World air) stays in the default region.
+///
+/// The regions use the global production cuts until /toy/region/cut gives
+/// them their own. The user limits (maximum step, minimum kinetic energy
+/// of charged particles) need G4StepLimiterPhysics, which the first
+/// /toy/region/maxStep or /toy/region/minEkin registers in the physics
+/// list, so these must come before /run/initialize; the values can be
+/// changed between runs. The commands act on the master only.
+
+class DetectorRegions
+{
+  public:
+    DetectorRegions(G4VModularPhysicsList* physicsList);
+    ~DetectorRegions();
+
+    /// Region names, in the order of the reports
+    static const std::vector<G4String>& Names();
+    /// Make the root volumes of the regions, found by name, and give
+    /// every volume the user limits of its region. Called by
+    /// DetectorConstruction each time the geometry is built.
+    static void AssignVolumes();
+
+  private:
+    void DefineCommands();
+    void SetCut(const G4String& definition);
+    void SetMaxStep(const G4String& definition);
+    void SetMinEkin(const G4String& definition);
+    G4bool ReadValue(const G4String& definition, const G4String& category,
+                     G4String& region, G4double& value) const;
+    void RegisterStepLimiter();
+
+    G4GenericMessenger*    fMessenger;
+    G4VModularPhysicsList* fPhysicsList;
+    G4bool                 fRegistered;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,37 @@
+/// \file DetectorSD.hh
+/// \brief Definition of the DetectorSD class
+
+#ifndef DetectorSD_h
+#define DetectorSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+
+#include "DetectorHit.hh"
+
+class G4Step;
+class G4HCofThisEvent;
+
+/// Sensitive detector class
+///
+/// Attached to DetectorTub and Scintillator. Every step of a track inside
+/// the volume creates a DetectorHit in the hits collection of the event,
+/// so steps elsewhere in the setup cost nothing.
+
+class DetectorSD : public G4VSensitiveDetector
+{
+  public:
+    DetectorSD(const G4String& name,
+               const G4String& hitsCollectionName);
+    virtual ~DetectorSD();
+
+    // methods from base class
+    virtual void   Initialize(G4HCofThisEvent* hitCollection);
+    virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory* history);
+
+  private:
+    DetectorHitsCollection* fHitsCollection;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
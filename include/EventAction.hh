@@ -5,12 +5,22 @@
 #define EventAction_h 1
 
 #include "G4UserEventAction.hh"
+#include "DetectorHit.hh"
 #include "globals.hh"
 
+#include <vector>
+
 class RunAction;
 
 /// Event action class
 ///
+/// At the end of the event the DetectorTub hits collection is handed to
+/// the ntuple writer of the run action, depending on its output mode one
+/// row per step, one row per track or one summary row for the whole event
+/// (per track and event one row per weight, see the README on biasing).
+/// With the event trigger active, only events it accepts are written and
+/// histogrammed.
+/// Every event is counted by the progress monitor.
 
 class EventAction : public G4UserEventAction
 {
@@ -18,11 +28,19 @@ class EventAction : public G4UserEventAction
     EventAction(RunAction* runAction);
     virtual ~EventAction();
 
-    virtual void BeginOfEventAction(const G4Event* event);
     virtual void EndOfEventAction(const G4Event* event);
 
   private:
+    void FillSteps(const DetectorHitsCollection* hc, G4int eventID);
+    void FillTracks(const DetectorHitsCollection* hc, G4int eventID);
+    void FillEvent(const DetectorHitsCollection* hc, G4int eventID);
+
     RunAction* fRunAction;
+    G4int      fDetectorHCID;
+    G4int      fScintillatorHCID;
+    G4bool     fFirstEventDone;
+    // Distinct hit weights of the event, FillEvent
+    std::vector<G4double> fWeights;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,102 @@
+/// \file EventHistograms.hh
+/// \brief Definition of the EventHistograms class
+
+#ifndef EventHistograms_h
+#define EventHistograms_h 1
+
+#include "DetectorHit.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+class NtupleWriter;
+
+/// H1 and H2 histograms of event quantities, booked with the /toy/histo/
+/// commands before the run and filled in EndOfEventAction from the hits
+/// collections, so that the distributions which are analysed need no
+/// ntuple:
+///   neutronEnergy    - kinetic energy of the first neutron entering
+///                      DetectorTub
+///   detectorEdep     - energy deposited in DetectorTub
+///   scintillatorEdep - energy deposited in the Scintillator
+///   scatterAngle     - angle between source -> last Scintillator
+///                      interaction and interaction -> DetectorTub entry of
+///                      the neutron reaching DetectorTub after interacting in
+///                      the Scintillator (the angle an experiment
+///                      reconstructs)
+///   tof              - time from the first Scintillator deposit to the
+///                      first DetectorTub hit
+/// An event fills a histogram when its quantities are defined (e.g. a
+/// deposit above zero). With forced collision the histories of one event
+/// (the biased and the unbiased copy of a track, with their secondaries)
+/// carry different weights: the hits are grouped by weight, and each group
+/// fills the histograms with its own quantities and weight, so that
+/// deposits of different histories are not added. Without biasing an
+/// event is one group. The histograms go to the
+/// output file next to the ntuple; G4AnalysisManager merges them over the
+/// threads, toyMerge --h1/--h2 over the shards.
+
+class EventHistograms
+{
+  public:
+    enum Quantity { kNeutronEnergy = 0, kDetectorEdep, kScintillatorEdep,
+                    kScatterAngle, kTof, kNofQuantities };
+
+    EventHistograms();
+    ~EventHistograms();
+
+    G4bool IsActive() const { return !fH1.empty() || !fH2.empty(); }
+
+    /// Compute the quantities of an event (collections may be null) and
+    /// fill the histograms through the writer of the thread, which owns
+    /// the analysis manager while it runs
+    void Fill(const DetectorHitsCollection* scintillator,
+              const DetectorHitsCollection* detector,
+              const G4ThreeVector& source, NtupleWriter* writer);
+
+    /// "quantity nbins min max unit"
+    void BookH1(const G4String& definition);
+    /// "xquantity nxbins xmin xmax xunit yquantity nybins ymin ymax yunit"
+    void BookH2(const G4String& definition);
+
+  private:
+    struct Axis {
+      Quantity quantity;
+      G4int    nBins;
+      G4double min;
+      G4double max;
+      G4String unit;
+    };
+    struct Histogram {
+      G4int id;
+      Axis  x;
+      Axis  y;
+    };
+
+    // Quantities of the hits of one weight, in Geant4 units
+    struct Group {
+      G4double weight;
+      G4double value[kNofQuantities];
+      G4bool   defined[kNofQuantities];
+      G4double scintillatorTime;
+      G4double detectorTime;
+    };
+
+    Group& GroupOf(G4double weight);
+    G4bool ReadAxis(std::istream& in, Axis& axis) const;
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    std::vector<Histogram> fH1;
+    std::vector<Histogram> fH2;
+
+    // Groups of the current event, the first fNofGroups are used
+    std::vector<Group> fGroups;
+    size_t fNofGroups;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,57 @@
+/// \file EventTrigger.hh
+/// \brief Definition of the EventTrigger class
+
+#ifndef EventTrigger_h
+#define EventTrigger_h 1
+
+#include "DetectorHit.hh"
+#include "G4Accumulable.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Scintillator - DetectorTub coincidence trigger, configured with the
+/// /toy/trigger/ commands.
+///
+/// The hits of an event are buffered in the hits collections of the two
+/// sensitive detectors during tracking; EventAction writes the DetectorTub
+/// hits only if the trigger accepts the event:
+/// - the energy deposited in the Scintillator is above the threshold,
+/// - there is a hit in DetectorTub,
+/// - optionally (sameTrack), a track which interacted in the Scintillator
+///   reaches DetectorTub, i.e. the neutron scattered towards it,
+/// - optionally (timeWindow), the first DetectorTub hit follows the first
+///   Scintillator deposit within the window.
+/// Tested and accepted events are counted, merged over the threads and
+/// printed at the end of the run.
+
+class EventTrigger
+{
+  public:
+    EventTrigger();
+    ~EventTrigger();
+
+    G4bool IsActive() const { return fActive; }
+
+    /// Apply the trigger to the hits of an event (collections may be null)
+    G4bool Accept(const DetectorHitsCollection* scintillator,
+                  const DetectorHitsCollection* detector);
+
+    void Print() const;
+
+  private:
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fActive;
+    G4double fThreshold;
+    G4double fTimeWindow;
+    G4bool   fSameTrack;
+
+    G4Accumulable<G4double> fNofTested;
+    G4Accumulable<G4double> fNofAccepted;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
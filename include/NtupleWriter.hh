@@ -0,0 +1,96 @@
+/// \file NtupleWriter.hh
+/// \brief Definition of the NtupleWriter class
+
+#ifndef NtupleWriter_h
+#define NtupleWriter_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class G4GenericMessenger;
+class G4VAnalysisManager;
+
+/// Ntuple output stage between the event loop and the analysis manager of
+/// the thread which creates it.
+///
+/// EventAction fills rows, and EventHistograms its histograms, with the
+/// same calls as on G4AnalysisManager. In async mode (default,
+/// /toy/output/async) AddNtupleRow(), FillH1() and FillH2() only copy the
+/// entry into a bounded single-producer single-consumer ring buffer, and a
+/// writer thread, started with the first row of the run, drains it in
+/// batches into the analysis manager of the event loop thread, where the
+/// ROOT baskets are compressed and written. The event loop thread does not
+/// touch the analysis manager while the writer runs, so it fills nothing
+/// there but through this class. When the buffer is
+/// full the event loop waits for free slots (backpressure); such waits are
+/// counted and reported. Flush() drains the buffer and stops the writer,
+/// it has to be called before the file is written and closed.
+
+class NtupleWriter
+{
+  public:
+    NtupleWriter();
+    ~NtupleWriter();
+
+    void FillNtupleIColumn(G4int column, G4int value)
+      { fRow.cells[column].i = value; fRow.floatMask &= ~(1u << column);
+        fRow.filledMask |= 1u << column; }
+    void FillNtupleFColumn(G4int column, G4float value)
+      { fRow.cells[column].f = value; fRow.floatMask |= 1u << column;
+        fRow.filledMask |= 1u << column; }
+    void AddNtupleRow();
+    void FillH1(G4int id, G4double x, G4double weight);
+    void FillH2(G4int id, G4double x, G4double y, G4double weight);
+
+    /// Wait until all rows are in the analysis manager, stop the writer
+    void Flush();
+
+  private:
+    static constexpr G4int kMaxColumns = 32;
+    union Cell {
+      G4int   i;
+      G4float f;
+    };
+    struct Row {
+      Cell          cells[kMaxColumns];
+      std::uint32_t floatMask = 0;
+      std::uint32_t filledMask = 0;
+      // A histogram fill instead of a row if h1 or h2 is set
+      G4int    h1 = -1;
+      G4int    h2 = -1;
+      G4double x = 0.;
+      G4double y = 0.;
+      G4double weight = 1.;
+    };
+
+    void Push(const Row& row);
+    void Start();
+    void Run();
+    size_t Drain();
+    void Write(const Row& row);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4VAnalysisManager* fAnalysisManager;
+    G4bool fAsync;
+    G4int  fBufferSize;
+
+    Row fRow;
+    std::vector<Row> fBuffer;
+    size_t fMask;
+    // Producer index, written by the event loop; consumer index, written
+    // by the writer thread. Both only grow.
+    alignas(64) std::atomic<size_t> fHead;
+    alignas(64) std::atomic<size_t> fTail;
+    std::atomic<G4bool> fStop;
+    std::thread fThread;
+    G4long fNofStalls;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
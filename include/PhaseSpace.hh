@@ -0,0 +1,41 @@
+/// \file PhaseSpace.hh
+/// \brief Layout of the phase-space files of the two-stage simulation
+
+#ifndef PhaseSpace_h
+#define PhaseSpace_h 1
+
+#include <cstdint>
+
+/// A phase-space file is a PhaseSpaceHeader followed by nRecords
+/// PhaseSpaceRecords, little endian, written by PhaseSpaceRecorder and
+/// replayed by PhaseSpaceSource. Positions in mm, energy in MeV, time in
+/// ns. nPrimaries is the number of stage-one events the file stands for:
+/// a stage-two tally per stage-one primary is the weighted tally divided
+/// by nPrimaries (and by the number of passes, if the file is reused).
+
+struct PhaseSpaceHeader
+{
+  char         magic[8];      // "TOYPHSP1"
+  std::int32_t recordSize;    // sizeof(PhaseSpaceRecord)
+  std::int32_t reserved;
+  std::int64_t nPrimaries;
+  std::int64_t nRecords;
+};
+
+struct PhaseSpaceRecord
+{
+  std::int32_t pdg;
+  std::int32_t eventID;       // stage-one event, within its shard
+  float        x, y, z;
+  float        dx, dy, dz;
+  float        energy;
+  float        time;
+  float        weight;
+};
+
+static_assert(sizeof(PhaseSpaceHeader) == 32, "PhaseSpaceHeader layout");
+static_assert(sizeof(PhaseSpaceRecord) == 44, "PhaseSpaceRecord layout");
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
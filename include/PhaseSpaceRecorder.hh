@@ -0,0 +1,71 @@
+/// \file PhaseSpaceRecorder.hh
+/// \brief Definition of the PhaseSpaceRecorder class
+
+#ifndef PhaseSpaceRecorder_h
+#define PhaseSpaceRecorder_h 1
+
+#include "PhaseSpace.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Step;
+class G4Run;
+class G4LogicalVolume;
+class G4GenericMessenger;
+
+/// Stage one of the two-stage simulation, configured with the /toy/record/
+/// commands.
+///
+/// Every particle entering the record volume from outside (not from one
+/// of its daughters) is written to the phase-space file (see PhaseSpace.hh)
+/// and, by default, killed, so that nothing is transported beyond the
+/// surface. Without /toy/record/file the file is named after the output
+/// file of the run, out/run_0007.root -> out/run_0007.phsp, so that every
+/// shard writes its own. A file given with /toy/record/file takes the
+/// suffixes of the ROOT file, the /toy/det/ configuration tag and the
+/// checkpoint segment, rec.phsp -> rec_EJ276_30deg_45.72mm_seg0003.phsp:
+/// every run writes a file of its own, and a segment run again on resume
+/// rewrites its file instead of adding to it. The records of each thread
+/// are buffered
+/// and appended to the one file under a lock. The master opens the file at
+/// the start of the run and closes it at the end, when the workers have
+/// flushed their buffers, writing the number of primaries of the run into
+/// the header.
+
+class PhaseSpaceRecorder
+{
+  public:
+    PhaseSpaceRecorder();
+    ~PhaseSpaceRecorder();
+
+    G4bool IsActive() const { return !fVolumeName.empty(); }
+
+    /// Record the track if the step enters the volume; true if the track
+    /// is to be killed
+    G4bool Record(const G4Step* step);
+
+    /// outputFile: the ROOT file of the run, which names the default file;
+    /// suffix: the tag and segment suffix inserted in a /toy/record/file
+    void BeginOfRun(G4bool isMaster, const G4String& outputFile,
+                    const G4String& suffix);
+    void EndOfRun(const G4Run* run, G4bool isMaster);
+
+  private:
+    void Flush();
+    void SetVolume(const G4String& name);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4String fVolumeName;
+    G4String fFileName;
+    G4String fRunFileName;
+    G4bool   fKill;
+    const G4LogicalVolume* fVolume;
+    G4bool   fResolved;
+    std::vector<PhaseSpaceRecord> fBuffer;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
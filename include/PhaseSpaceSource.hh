@@ -0,0 +1,54 @@
+/// \file PhaseSpaceSource.hh
+/// \brief Definition of the PhaseSpaceSource class
+
+#ifndef PhaseSpaceSource_h
+#define PhaseSpaceSource_h 1
+
+#include "PhaseSpace.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Event;
+class G4GenericMessenger;
+
+/// Stage two of the two-stage simulation, configured with the /toy/replay/
+/// commands.
+///
+/// Replaces the GPS as primary source: every event takes the next record
+/// of the phase-space file and starts `recycle` copies of the particle
+/// (default 1), each with the recorded weight divided by `recycle`. The
+/// threads share the file and take chunks of records under a lock. Shard
+/// k of N replays only the k-th of N equal slices of the records, so that
+/// the shards of a job replay different particles and their summed
+/// tallies stand for the nPrimaries of the header. At the end of its slice
+/// the shard rewinds to its start with a warning; the passes count in the
+/// normalisation (see PhaseSpace.hh).
+
+class PhaseSpaceSource
+{
+  public:
+    PhaseSpaceSource();
+    ~PhaseSpaceSource();
+
+    G4bool IsActive() const { return !fFileName.empty(); }
+
+    void GeneratePrimaries(G4Event* event);
+
+    /// The shard of the job, set once by main()
+    static void SetShard(G4int shard, G4int nShards);
+
+  private:
+    void ReadChunk();
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4String fFileName;
+    G4int    fRecycle;
+    std::vector<PhaseSpaceRecord> fChunk;
+    size_t   fNext;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
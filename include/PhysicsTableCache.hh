@@ -0,0 +1,41 @@
+/// \file PhysicsTableCache.hh
+/// \brief Definition of the PhysicsTableCache class
+
+#ifndef PhysicsTableCache_h
+#define PhysicsTableCache_h 1
+
+#include "globals.hh"
+
+class G4VUserPhysicsList;
+
+/// Physics tables stored once and retrieved by the production jobs.
+///
+///   toyMC_batch --store-physics-tables dir   builds the tables (beamOn 0)
+///                                            and stores them in dir
+///   toyMC_batch --physics-tables dir ...     retrieves them at the first
+///                                            run instead of building them
+/// dir/toyMC.stamp records what the tables depend on beyond the materials
+/// and cuts, which Geant4 checks itself when retrieving: the Geant4
+/// version, the physics list and the EM data set (G4LEDATA). A missing or
+/// different stamp means the tables are stale, and they are built as
+/// usual. Tables of processes which cannot be stored (most of the hadronic
+/// ones) are always built.
+
+class PhysicsTableCache
+{
+  public:
+    /// Retrieve the tables from dir if its stamp matches, true if so
+    static G4bool Retrieve(G4VUserPhysicsList* physicsList,
+                           const G4String& listName, const G4String& dir);
+    /// Store the built tables and the stamp in dir, true on success
+    static G4bool Store(G4VUserPhysicsList* physicsList,
+                        const G4String& listName, const G4String& dir);
+    /// Build the tables after all, e.g. for physics added after Retrieve()
+    static void Cancel(const G4String& reason);
+    /// Whether the tables of the current job are retrieved
+    static G4bool IsRetrieved();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -7,16 +7,33 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
 #include "G4GeneralParticleSource.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
 class G4ParticleGun;
 class G4Event;
 class G4Box;
+class G4GenericMessenger;
+class PhaseSpaceSource;
+class DDNeutronSource;
 
 /// The primary generator action class with particle gun.
 ///
-/// The default kinematic is a 6 MeV gamma, randomly distribued 
-/// in front of the phantom across 80% of the (X,Y) phantom size.
+/// The kinematics is defined with the /gps commands (see run1.mac).
+///
+/// With /toy/source/bias the isotropic GPS direction is replaced by a
+/// biased one: with probability biasFraction the direction is drawn
+/// uniformly in a cone of half-angle biasConeAngle around the line from
+/// the vertex to biasTarget (by default the scintillator, seen through the
+/// guide pipe), otherwise isotropically. The vertex weight is the ratio of
+/// the isotropic to the biased density, so weighted results stay unbiased;
+/// a GPS source with another /gps/ang/type stops the run.
+///
+/// With /toy/dd/table the GPS is replaced by the DD neutron source, whose
+/// energy follows the emission angle (see DDNeutronSource); the biased
+/// direction then gets the weight of the DD angular distribution. With
+/// /toy/replay/file the primaries are read from a phase-space file instead
+/// (stage two, see PhaseSpaceSource).
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
@@ -29,7 +46,21 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     const G4GeneralParticleSource* GetParticleGun() const {return fParticleGun;}
   
   private:
+    void DefineCommands();
+    G4double BiasDirection(G4PrimaryVertex* vertex);
+    G4ThreeVector SampleBiasedDirection(const G4ThreeVector& position,
+                                        G4double& density) const;
+    void GenerateDD(G4Event* event);
+
     G4GeneralParticleSource*  fParticleGun;
+    G4GenericMessenger*       fMessenger;
+    PhaseSpaceSource*         fReplay;
+    DDNeutronSource*          fDDSource;
+
+    G4bool        fBias;
+    G4ThreeVector fBiasTarget;
+    G4double      fBiasConeAngle;
+    G4double      fBiasFraction;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,65 @@
+/// \file ProgressMonitor.hh
+/// \brief Definition of the ProgressMonitor class
+
+#ifndef ProgressMonitor_h
+#define ProgressMonitor_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+
+class G4Run;
+class G4GenericMessenger;
+
+/// Time-based progress reports, configured with the /toy/progress/
+/// commands; replaces the "Begin event" line every 1000 events.
+///
+/// Every event loop thread appends a JSON record to the status file of the
+/// shard (by default the output file name with .status instead of .root)
+/// each interval (default 60 s) and at the end of the run:
+///   host, shard, thread, run, events of the thread in the run, events/s
+///   and steps/s of the thread since its previous record, events done and
+///   to do in the shard job, events/s and ETA of the shard, resident memory
+///   of the process and size of the output file.
+/// The job counts cover the segments of a checkpointed /toy/run/beamOn
+/// (see CheckpointManager), otherwise the current run. The first thread
+/// also prints a one-line summary.
+
+class ProgressMonitor
+{
+  public:
+    ProgressMonitor();
+    ~ProgressMonitor();
+
+    /// Events of the whole job and events done before the next run
+    static void SetJob(G4long nEvents, G4long nDone);
+
+    void BeginOfRun(const G4Run* run, G4bool isMaster, G4int shard,
+                    const G4String& dataFile, const G4String& outputFile);
+    /// nSteps: steps of the thread in the run so far
+    void EndOfEvent(G4double nSteps);
+    void EndOfRun(G4bool isMaster);
+
+  private:
+    void Report(std::chrono::steady_clock::time_point now);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4double fInterval;
+    G4String fFileName;
+    G4String fStatusFile;
+    G4String fOutputFile;
+    G4int    fShard;
+    G4int    fRunID;
+    G4bool   fInRun;
+    G4long   fNofEvents;
+    G4double fNofSteps;
+    G4long   fLastEvents;
+    G4double fLastSteps;
+    std::chrono::steady_clock::time_point fRunStart;
+    std::chrono::steady_clock::time_point fLastReport;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,44 @@
+/// \file RegionSecondaries.hh
+/// \brief Definition of the RegionSecondaries class
+
+#ifndef RegionSecondaries_h
+#define RegionSecondaries_h 1
+
+#include "G4Accumulable.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Track;
+class G4Region;
+
+/// Secondaries produced per region (see DetectorRegions), as gammas,
+/// electrons, positrons and other particles. Filled by StackingAction for
+/// every new secondary, killed or not, merged over the threads and
+/// printed at the end of the run with the production cut of each region,
+/// to tune the cuts against the number of tracks they save.
+
+class RegionSecondaries
+{
+  public:
+    enum Particle { kGamma = 0, kElectron, kPositron, kOther, kNofParticles };
+
+    RegionSecondaries();
+    ~RegionSecondaries() = default;
+
+    void Count(const G4Track* track);
+    void Print() const;
+
+  private:
+    G4int RegionIndex(const G4Region* region);
+
+    // The regions of DetectorRegions, then the rest of the world
+    std::vector<const G4Region*> fRegions;
+    std::vector<G4String> fNames;
+    // One entry per region and particle
+    std::vector<G4Accumulable<G4double>> fCounts;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -8,12 +8,29 @@
 #include "G4Accumulable.hh"
 #include "globals.hh"
 
+#include <chrono>
+
 class G4Run;
+class TrackKillPolicy;
+class SteppingProfiler;
+class NtupleWriter;
+class EventTrigger;
+class PhaseSpaceRecorder;
+class ProgressMonitor;
+class EventHistograms;
+class RegionSecondaries;
+
+/// Layout of the output ntuple:
+/// Step  - "event" ntuple, one row per step in DetectorTub (default)
+/// Track - "track" ntuple, one row per track entering DetectorTub
+/// Event - "summary" ntuple, one row per event with a DetectorTub hit
+/// None  - no ntuple, only the /toy/histo/ histograms
+enum class OutputMode { Step, Track, Event, None };
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction();
+    RunAction(OutputMode mode = OutputMode::Step);
     ~RunAction();// override = default;
 
     void BeginOfRunAction(const G4Run*) override;
@@ -22,8 +39,60 @@ class RunAction : public G4UserRunAction
     {
       m_hDataFilename = hFilename;
     }
+    void SetShard(G4int shard) { fShard = shard; }
+    /// Runs are segments of this many events of a checkpointed job, see
+    /// CheckpointManager; 0 = not checkpointed
+    void SetCheckpointInterval(G4int nEvents) { fCheckpointInterval = nEvents; }
+    /// Append a benchmark record of every run to this file (JSON lines)
+    void SetBenchmark(const G4String& fileName, const G4String& name)
+    {
+      fBenchFile = fileName;
+      fBenchName = name;
+    }
+    /// For the benchmark records
+    void SetPhysicsListName(const G4String& name) { fPhysicsListName = name; }
+    /// Called by TrackingAction at the end of every track
+    void CountSteps(G4int nSteps) { fNofSteps += nSteps; }
+    /// Steps of this thread in the current run
+    G4double GetNofSteps() const { return fNofSteps.GetValue(); }
+    OutputMode GetOutputMode() const { return fOutputMode; }
+    G4int GetShard() const { return fShard; }
+    /// Events of the job before the current run (previous segments)
+    G4int GetEventOffset() const { return fEventOffset; }
+    TrackKillPolicy* GetKillPolicy() const { return fKillPolicy; }
+    SteppingProfiler* GetProfiler() const { return fProfiler; }
+    NtupleWriter* GetWriter() const { return fWriter; }
+    EventTrigger* GetTrigger() const { return fTrigger; }
+    PhaseSpaceRecorder* GetRecorder() const { return fRecorder; }
+    ProgressMonitor* GetProgress() const { return fProgress; }
+    EventHistograms* GetHistograms() const { return fHistograms; }
+    RegionSecondaries* GetSecondaries() const { return fSecondaries; }
+
+    /// Version of the ntuple layout, written into the ntuple titles
+    static constexpr G4int kSchemaVersion = 3;
+
   private:
+    void WriteBenchmark(const G4Run* run) const;
+
     G4String m_hDataFilename;
+    G4String fFileName;
+    OutputMode fOutputMode;
+    G4int fShard;
+    G4int fCheckpointInterval;
+    G4int fEventOffset;
+    TrackKillPolicy* fKillPolicy;
+    SteppingProfiler* fProfiler;
+    NtupleWriter* fWriter;
+    EventTrigger* fTrigger;
+    PhaseSpaceRecorder* fRecorder;
+    ProgressMonitor* fProgress;
+    EventHistograms* fHistograms;
+    RegionSecondaries* fSecondaries;
+    G4Accumulable<G4double> fNofSteps;
+    G4String fBenchFile;
+    G4String fBenchName;
+    G4String fPhysicsListName;
+    std::chrono::steady_clock::time_point fRunStart;
 };
 #endif
 
@@ -0,0 +1,44 @@
+/// \file ScintillatorBiasing.hh
+/// \brief Definition of the ScintillatorBiasing class
+
+#ifndef ScintillatorBiasing_h
+#define ScintillatorBiasing_h 1
+
+#include "globals.hh"
+
+class G4VModularPhysicsList;
+class G4GenericMessenger;
+class DetectorConstruction;
+
+/// Forced collision of neutrons in the Scintillator with the Geant4
+/// generic biasing, switched on with /toy/biasing/forceCollision before
+/// /run/initialize.
+///
+/// The command registers G4GenericBiasingPhysics for neutrons in the
+/// physics list (possible only in the PreInit state, so it is not passed
+/// on to the worker threads) and makes DetectorConstruction attach a
+/// G4BOptrForceCollision operator to the Scintillator in every thread.
+/// Each neutron entering the Scintillator then interacts in it, with the
+/// weight of the interaction probability, while an unbiased copy flies
+/// through with the complementary weight; the weights reach the ntuple
+/// through the hits.
+
+class ScintillatorBiasing
+{
+  public:
+    ScintillatorBiasing(G4VModularPhysicsList* physicsList,
+                        DetectorConstruction* detector);
+    ~ScintillatorBiasing();
+
+  private:
+    void SetForceCollision(G4bool enable);
+
+    G4GenericMessenger*    fMessenger;
+    G4VModularPhysicsList* fPhysicsList;
+    DetectorConstruction*  fDetector;
+    G4bool                 fRegistered;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,35 @@
+/// \file StackingAction.hh
+/// \brief Definition of the StackingAction class
+
+#ifndef StackingAction_h
+#define StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+class TrackKillPolicy;
+class RegionSecondaries;
+
+/// Stacking action class
+///
+/// New secondaries are counted per region of their creation point; new
+/// tracks which the kill policy rejects are not stacked at all.
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction(TrackKillPolicy* killPolicy,
+                   RegionSecondaries* secondaries);
+    virtual ~StackingAction();
+
+    // method from the base class
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+
+  private:
+    TrackKillPolicy* fKillPolicy;
+    RegionSecondaries* fSecondaries;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,33 @@
+/// \file StartupTimer.hh
+/// \brief Definition of the StartupTimer class
+
+#ifndef StartupTimer_h
+#define StartupTimer_h 1
+
+#include "globals.hh"
+
+/// Wall-clock timing of the startup phases of a job (materials, geometry,
+/// physics tables, first event, ...).
+///
+/// Mark() is called where a phase ends and prints its duration, since the
+/// previous mark, the time since Start() and the resident memory of the
+/// process with its growth during the phase. Only the first mark of a
+/// phase is printed, so it can be called from code which runs once per
+/// run or per thread. Thread safe.
+
+class StartupTimer
+{
+  public:
+    static void Start();
+    static void Mark(const G4String& phase);
+    /// Duration and resident memory at the end of a marked phase, false
+    /// if the phase was not marked
+    static G4bool GetPhase(const G4String& phase, G4double& seconds,
+                           long& residentKB);
+    /// Current resident memory of the process
+    static long ResidentKB();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
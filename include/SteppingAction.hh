@@ -7,25 +7,30 @@
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
 
-class EventAction;
-
-class G4LogicalVolume;
+class RunAction;
+class TrackKillPolicy;
+class SteppingProfiler;
+class PhaseSpaceRecorder;
 
 /// Stepping action class
-/// 
+///
+/// Applies the kill policy to tracks in flight, after every step, feeds
+/// the stepping profiler and the phase-space recorder. Detector data are
+/// recorded by the sensitive detectors, not here.
 
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(EventAction* eventAction);
+    SteppingAction(RunAction* runAction);
     virtual ~SteppingAction();
 
     // method from the base class
     virtual void UserSteppingAction(const G4Step*);
 
   private:
-    EventAction*  fEventAction;
-    G4LogicalVolume* fScoringVolume;
+    TrackKillPolicy* fKillPolicy;
+    SteppingProfiler* fProfiler;
+    PhaseSpaceRecorder* fRecorder;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,72 @@
+/// \file SteppingProfiler.hh
+/// \brief Definition of the SteppingProfiler class
+
+#ifndef SteppingProfiler_h
+#define SteppingProfiler_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <map>
+#include <utility>
+
+class G4Step;
+class G4Track;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4GenericMessenger;
+
+/// Stepping profiler, switched on with /toy/profile/enable.
+///
+/// Counts tracks (in the volume where they start), steps and wall time
+/// per logical volume and particle species. The time of a step is the
+/// time since the previous step of the thread, or since the start of the
+/// track, and is booked to the pre-step volume; it includes the user
+/// code run for the step. The tables of the workers are merged into the
+/// master like the other accumulables, so in MT mode the times are summed
+/// over the threads. Printed at the end of the run.
+
+class SteppingProfiler : public G4VAccumulable
+{
+  public:
+    SteppingProfiler();
+    virtual ~SteppingProfiler();
+
+    G4bool IsActive() const { return fActive; }
+
+    /// Called by TrackingAction and SteppingAction when active
+    void StartTrack(const G4Track* track);
+    void Step(const G4Step* step);
+
+    // methods from the base class
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void Print() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using Key = std::pair<const G4LogicalVolume*, const G4ParticleDefinition*>;
+    struct Entry {
+      G4long   nTracks = 0;
+      G4long   nSteps = 0;
+      G4double time = 0.;  // s
+    };
+
+    Entry& Lookup(const G4LogicalVolume* volume,
+                  const G4ParticleDefinition* particle);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger;
+    G4bool fActive;
+    std::map<Key, Entry> fEntries;
+    // Consecutive steps are mostly in the same volume, same particle
+    Key    fLastKey;
+    Entry* fLastEntry;
+    Clock::time_point fLastTime;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,67 @@
+/// \file TrackKillPolicy.hh
+/// \brief Definition of the TrackKillPolicy class
+
+#ifndef TrackKillPolicy_h
+#define TrackKillPolicy_h 1
+
+#include "G4Accumulable.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Track;
+class G4LogicalVolume;
+class G4GenericMessenger;
+
+/// Track killing policy, configured with the /toy/kill/ commands.
+///
+/// Tracks are killed when they are born in or enter one of the kill
+/// volumes, when a neutron falls below the energy threshold, or when the
+/// global time exceeds the time cut. Used by StackingAction for new
+/// tracks and by SteppingAction for tracks in flight. The number, weight
+/// and kinetic energy of the killed tracks are accumulated per reason,
+/// merged over the threads and printed at the end of the run, so that the
+/// bias can be checked.
+
+class TrackKillPolicy
+{
+  public:
+    enum Reason { kVolume = 0, kEnergy, kTime, kNofReasons };
+
+    TrackKillPolicy();
+    ~TrackKillPolicy();
+
+    /// Whether any cut is set; if not, nothing needs to be checked
+    G4bool IsActive() const
+      { return fEnergyThreshold > 0. || fTimeCut > 0. || !fVolumeNames.empty(); }
+
+    /// Apply the policy to a track, counting it if it is to be killed
+    G4bool Kill(const G4Track* track, const G4LogicalVolume* volume);
+
+    void AddVolume(const G4String& name);
+    /// Look the kill volumes up again when next needed
+    void ResetVolumes() { fResolved = fVolumeNames.empty(); }
+    void Print() const;
+
+  private:
+    void DefineCommands();
+    void ResolveVolumes();
+    void Count(Reason reason, const G4Track* track);
+
+    G4GenericMessenger* fMessenger;
+
+    std::vector<G4String> fVolumeNames;
+    std::vector<const G4LogicalVolume*> fVolumes;
+    G4bool   fResolved;
+    G4double fEnergyThreshold;
+    G4double fTimeCut;
+
+    // One entry per reason
+    std::vector<G4Accumulable<G4double>> fNofKilled;
+    std::vector<G4Accumulable<G4double>> fKilledWeight;
+    std::vector<G4Accumulable<G4double>> fKilledEnergy;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,35 @@
+/// \file TrackingAction.hh
+/// \brief Definition of the TrackingAction class
+
+#ifndef TrackingAction_h
+#define TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+class RunAction;
+class SteppingProfiler;
+
+/// Tracking action class
+///
+/// Starts the clock of the stepping profiler for every new track, and
+/// adds the steps of every finished track to the run step count.
+
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction(RunAction* runAction);
+    virtual ~TrackingAction();
+
+    // method from the base class
+    virtual void PreUserTrackingAction(const G4Track*);
+    virtual void PostUserTrackingAction(const G4Track*);
+
+  private:
+    RunAction*        fRunAction;
+    SteppingProfiler* fProfiler;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
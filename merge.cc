@@ -0,0 +1,469 @@
+/// \file merge.cc
+/// \brief Merge the ntuples of all shards of a job into one columnar output
+///
+/// Replaces merge.py. The shard files are read in parallel, one file per
+/// thread at a time, with the Geant4 ROOT reader (no ROOT installation is
+/// needed), and streamed into one columnar file <outdir>/<ntuple>.col:
+///   header  "TOYCOL01", nRows (uint64), nColumns (uint32), 0 (uint32)
+///   columns nColumns x { name (char[24]), numpy dtype (char[8], e.g.
+///           "<f4"), offset of the data in the file (uint64) }
+///   data    every column as a raw little-endian array of nRows values,
+///           8-byte aligned
+/// so that numpy maps a column without reading the others (see README).
+/// Nothing is kept in memory beyond the I/O buffers and, for the step
+/// ntuple, the step counters of the tracks of the recently read events.
+///
+/// On top of the ntuple columns the merged output has
+///   gEventID (int64) : shard * offset + eventID, from the columns of the
+///                      row, so it does not depend on the order of the
+///                      files; shards and checkpoint segments of a shard
+///                      (whose eventID counts on) never collide
+///   step     (int32) : ordinal of the step within its track, from 1
+///                      (step ntuple only)
+///
+/// The histograms named with --h1/--h2 (booked with /toy/histo/) are summed
+/// over all files into <outdir>/histograms.root; "-n none" merges only
+/// those.
+
+#include "G4RootAnalysisReader.hh"
+#include "G4RootAnalysisManager.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+
+  // Column layouts of the ntuples booked by RunAction (schema v3)
+  struct ColumnDef { const char* name; char type; };
+
+  const std::vector<ColumnDef> kStepColumns = {
+    {"Energy",'F'}, {"prex",'F'}, {"prey",'F'}, {"prez",'F'},
+    {"postx",'F'}, {"posty",'F'}, {"postz",'F'}, {"pdg",'I'},
+    {"eventID",'I'}, {"trackID",'I'}, {"parentID",'I'}, {"dE",'F'},
+    {"shard",'I'}, {"weight",'F'} };
+
+  const std::vector<ColumnDef> kSummaryColumns = {
+    {"Energy",'F'}, {"entryx",'F'}, {"entryy",'F'}, {"entryz",'F'},
+    {"exitx",'F'}, {"exity",'F'}, {"exitz",'F'}, {"dE",'F'},
+    {"nScatter",'I'}, {"nStep",'I'}, {"eventID",'I'}, {"shard",'I'} };
+
+  std::vector<ColumnDef> Schema(const G4String& ntupleName)
+  {
+    if (ntupleName == "event") return kStepColumns;
+    std::vector<ColumnDef> columns = kSummaryColumns;
+    if (ntupleName == "track") {
+      columns.push_back({"pdg",'I'});
+      columns.push_back({"trackID",'I'});
+      columns.push_back({"parentID",'I'});
+    }
+    else {
+      columns.push_back({"nTrack",'I'});
+    }
+    columns.push_back({"weight",'F'});
+    return columns;
+  }
+
+  // One output column of one shard, written to <outdir>/<name>.bin.part<k>
+  struct Column {
+    std::string name;
+    char type;
+    G4int i = 0;
+    G4float f = 0;
+    long long l = 0;
+    std::FILE* out = nullptr;
+
+    void Write() {
+      if (type == 'I') std::fwrite(&i, sizeof(i), 1, out);
+      else if (type == 'F') std::fwrite(&f, sizeof(f), 1, out);
+      else std::fwrite(&l, sizeof(l), 1, out);
+    }
+  };
+
+  const size_t kBufferSize = 1 << 20;
+
+  // Rows of the worker threads interleave in a merged ntuple at basket
+  // boundaries, far less than this many rows apart. The rows carry no
+  // thread, so the end of an event cannot be seen: an event not seen for
+  // this many rows is taken as complete and its step counters are
+  // dropped. This is a hard limit, a later row of such an event is an
+  // error (raise the limit) rather than a wrong step ordinal.
+  const long long kEventWindow = 1000000;
+
+  // Header of the merged file, and one entry per column
+  struct MergedHeader {
+    char          magic[8];
+    std::uint64_t nRows;
+    std::uint32_t nColumns;
+    std::uint32_t reserved;
+  };
+  struct MergedColumn {
+    char          name[24];
+    char          dtype[8];
+    std::uint64_t offset;
+  };
+
+  struct Options {
+    G4String outDir = "out/merged";
+    G4String ntuple = "event";
+    long long offset = 10000000;
+    unsigned nThreads = std::thread::hardware_concurrency();
+    std::vector<G4String> files;
+    std::vector<G4String> h1;
+    std::vector<G4String> h2;
+  };
+
+  std::mutex gPrintMutex;
+
+  void Exit(const std::string& message)
+  {
+    std::lock_guard<std::mutex> lock(gPrintMutex);
+    std::cerr << message << std::endl;
+    std::exit(1);
+  }
+
+  std::FILE* OpenOrExit(const std::string& name, const char* mode)
+  {
+    std::FILE* file = std::fopen(name.c_str(), mode);
+    if (!file) Exit("Cannot open " + name);
+    return file;
+  }
+
+  size_t SizeOf(char type) { return type == 'L' ? 8 : 4; }
+  const char* DType(char type)
+  {
+    return type == 'I' ? "<i4" : type == 'F' ? "<f4" : "<i8";
+  }
+
+  std::string PartName(const Options& opt, const std::string& column,
+                       size_t part)
+  {
+    return opt.outDir + "/" + column + ".bin.part" + std::to_string(part);
+  }
+
+  std::vector<Column> OutputColumns(const Options& opt)
+  {
+    std::vector<Column> columns;
+    for (const auto& def : Schema(opt.ntuple)) {
+      Column column;
+      column.name = def.name;
+      column.type = def.type;
+      columns.push_back(column);
+    }
+    Column gEventID;
+    gEventID.name = "gEventID";
+    gEventID.type = 'L';
+    columns.push_back(gEventID);
+    if (opt.ntuple == "event") {
+      Column step;
+      step.name = "step";
+      step.type = 'I';
+      columns.push_back(step);
+    }
+    return columns;
+  }
+
+  // Stream one shard file into its part files, return the number of rows
+  long long MergeFile(const Options& opt, size_t count)
+  {
+    const G4String& fileName = opt.files[count];
+    auto reader = G4RootAnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+    G4int ntupleId = reader->GetNtuple(opt.ntuple, fileName);
+    if (ntupleId < 0) {
+      std::lock_guard<std::mutex> lock(gPrintMutex);
+      std::cerr << fileName << ": no ntuple " << opt.ntuple
+                << ", skipped" << std::endl;
+      return -1;
+    }
+
+    std::vector<Column> columns = OutputColumns(opt);
+    Column* shard = nullptr;
+    Column* eventID = nullptr;
+    Column* trackID = nullptr;
+    Column* gEventID = nullptr;
+    Column* step = nullptr;
+    for (auto& column : columns) {
+      column.out = OpenOrExit(PartName(opt, column.name, count), "wb");
+      std::setvbuf(column.out, nullptr, _IOFBF, kBufferSize);
+      if (column.type == 'I' && column.name != "step") {
+        reader->SetNtupleIColumn(ntupleId, column.name, column.i);
+      }
+      else if (column.type == 'F') {
+        reader->SetNtupleFColumn(ntupleId, column.name, column.f);
+      }
+      if (column.name == "shard") shard = &column;
+      if (column.name == "eventID") eventID = &column;
+      if (column.name == "trackID") trackID = &column;
+      if (column.name == "gEventID") gEventID = &column;
+      if (column.name == "step") step = &column;
+    }
+
+    // Rows of one track are contiguous within a worker thread, but rows of
+    // different threads may interleave in a merged ntuple, so the step
+    // counter is looked up by (event, track) rather than by the last row.
+    // The counters of events which ended (see kEventWindow) are dropped,
+    // and the events marked as finished, per shard.
+    struct EventSteps {
+      long long lastRow = 0;
+      std::unordered_map<G4int, G4int> tracks;
+    };
+    std::unordered_map<long long, EventSteps> steps;
+    std::unordered_map<G4int, std::vector<bool>> finished;
+    long long nRows = 0;
+    while (reader->GetNtupleRow(ntupleId)) {
+      if (shard->i < 0 || eventID->i < 0 || eventID->i >= opt.offset) {
+        Exit(fileName + ": shard " + std::to_string(shard->i) + " eventID "
+             + std::to_string(eventID->i) + " does not fit --offset "
+             + std::to_string(opt.offset));
+      }
+      gEventID->l = shard->i * opt.offset + eventID->i;
+      if (step) {
+        std::vector<bool>& done = finished[shard->i];
+        if ((size_t) eventID->i < done.size() && done[eventID->i]) {
+          Exit(fileName + ": event " + std::to_string(gEventID->l)
+               + " continues more than " + std::to_string(kEventWindow)
+               + " rows after its last step, raise kEventWindow");
+        }
+        EventSteps& event = steps[gEventID->l];
+        event.lastRow = nRows;
+        step->i = ++event.tracks[trackID->i];
+        if (nRows % kEventWindow == 0) {
+          for (auto it = steps.begin(); it != steps.end(); ) {
+            if (it->second.lastRow + kEventWindow < nRows) {
+              G4int itShard = it->first / opt.offset;
+              size_t itEvent = it->first % opt.offset;
+              std::vector<bool>& itDone = finished[itShard];
+              if (itDone.size() <= itEvent) itDone.resize(itEvent + 1);
+              itDone[itEvent] = true;
+              it = steps.erase(it);
+            }
+            else {
+              ++it;
+            }
+          }
+        }
+      }
+      for (auto& column : columns) column.Write();
+      ++nRows;
+    }
+    for (auto& column : columns) std::fclose(column.out);
+
+    std::lock_guard<std::mutex> lock(gPrintMutex);
+    std::cout << fileName << ": " << nRows << " rows" << std::endl;
+    return nRows;
+  }
+
+  // Write the header and append the part files of all shards to their
+  // column, in command line order
+  void WriteMerged(const Options& opt, const std::vector<long long>& nRows,
+                   long long nTotal)
+  {
+    std::vector<Column> columns = OutputColumns(opt);
+    MergedHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "TOYCOL01", 8);
+    header.nRows = nTotal;
+    header.nColumns = columns.size();
+    std::vector<MergedColumn> entries(columns.size());
+    std::uint64_t offset
+      = sizeof(MergedHeader) + columns.size()*sizeof(MergedColumn);
+    for (size_t i = 0; i < columns.size(); ++i) {
+      std::memset(&entries[i], 0, sizeof(MergedColumn));
+      std::strncpy(entries[i].name, columns[i].name.c_str(),
+                   sizeof(entries[i].name) - 1);
+      std::strncpy(entries[i].dtype, DType(columns[i].type),
+                   sizeof(entries[i].dtype) - 1);
+      offset = (offset + 7) & ~std::uint64_t(7);
+      entries[i].offset = offset;
+      offset += nTotal*SizeOf(columns[i].type);
+    }
+
+    std::string name = opt.outDir + "/" + opt.ntuple + ".col";
+    std::FILE* out = OpenOrExit(name, "wb");
+    std::fwrite(&header, sizeof(header), 1, out);
+    std::fwrite(entries.data(), sizeof(MergedColumn), entries.size(), out);
+    std::vector<char> buffer(4*kBufferSize);
+    for (size_t i = 0; i < columns.size(); ++i) {
+      std::fseek(out, entries[i].offset, SEEK_SET);
+      for (size_t count = 0; count < opt.files.size(); ++count) {
+        if (nRows[count] < 0) continue;
+        std::string part = PartName(opt, columns[i].name, count);
+        std::FILE* in = OpenOrExit(part, "rb");
+        size_t n;
+        while ((n = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+          std::fwrite(buffer.data(), 1, n, out);
+        }
+        std::fclose(in);
+        std::remove(part.c_str());
+      }
+    }
+    if (std::fclose(out) != 0) Exit("Cannot write " + name);
+  }
+
+  // Sum every --h1/--h2 histogram of all files into a histogram of the
+  // same binning booked in the output manager
+  void MergeHistograms(const Options& opt)
+  {
+    auto reader = G4RootAnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+    auto manager = G4RootAnalysisManager::Instance();
+    manager->SetVerboseLevel(0);
+
+    for (const auto& name : opt.h1) {
+      tools::histo::h1d* sum = nullptr;
+      for (const auto& fileName : opt.files) {
+        G4int id = reader->ReadH1(name, fileName);
+        const tools::histo::h1d* h = id >= 0 ? reader->GetH1(id) : nullptr;
+        if (!h) {
+          std::cerr << fileName << ": no H1 " << name << ", skipped"
+                    << std::endl;
+          continue;
+        }
+        if (!sum) {
+          const auto& x = h->axis();
+          sum = manager->GetH1(manager->CreateH1(name, h->title(), x.bins(),
+                                                 x.lower_edge(),
+                                                 x.upper_edge()));
+        }
+        if (!sum->add(*h)) {
+          std::cerr << fileName << ": binning of " << name << " differs,"
+                    << " skipped" << std::endl;
+        }
+      }
+      if (sum) {
+        std::cout << name << ": " << sum->all_entries() << " entries"
+                  << std::endl;
+      }
+    }
+
+    for (const auto& name : opt.h2) {
+      tools::histo::h2d* sum = nullptr;
+      for (const auto& fileName : opt.files) {
+        G4int id = reader->ReadH2(name, fileName);
+        const tools::histo::h2d* h = id >= 0 ? reader->GetH2(id) : nullptr;
+        if (!h) {
+          std::cerr << fileName << ": no H2 " << name << ", skipped"
+                    << std::endl;
+          continue;
+        }
+        if (!sum) {
+          const auto& x = h->axis_x();
+          const auto& y = h->axis_y();
+          sum = manager->GetH2(manager->CreateH2(name, h->title(),
+                                 x.bins(), x.lower_edge(), x.upper_edge(),
+                                 y.bins(), y.lower_edge(), y.upper_edge()));
+        }
+        if (!sum->add(*h)) {
+          std::cerr << fileName << ": binning of " << name << " differs,"
+                    << " skipped" << std::endl;
+        }
+      }
+      if (sum) {
+        std::cout << name << ": " << sum->all_entries() << " entries"
+                  << std::endl;
+      }
+    }
+
+    G4String fileName = opt.outDir + "/histograms.root";
+    manager->OpenFile(fileName);
+    manager->Write();
+    manager->CloseFile();
+    std::cout << "Histograms written to " << fileName << std::endl;
+    delete manager;
+    delete reader;
+  }
+
+  void PrintUsage()
+  {
+    std::cerr << " Usage: " << std::endl;
+    std::cerr << " toyMerge [-j nThreads] [-o outdir] [-n ntuple]"
+              << " [--offset N] [--h1 name]... [--h2 name]... file.root..."
+              << std::endl;
+    std::cerr << "   -j       : reader threads (default: all cores)"
+              << std::endl;
+    std::cerr << "   -o       : output directory (default out/merged), gets"
+              << " <ntuple>.col" << std::endl;
+    std::cerr << "   -n       : ntuple, event|track|summary (default event),"
+              << " none for histograms only" << std::endl;
+    std::cerr << "   --offset : gEventID = shard * offset + eventID"
+              << " (default 1e7)" << std::endl;
+    std::cerr << "   --h1/h2  : sum this histogram into histograms.root"
+              << std::endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  for (G4int i = 1; i < argc; ++i) {
+    G4String arg = argv[i];
+    if (arg == "-j" && i+1 < argc) opt.nThreads = std::atoi(argv[++i]);
+    else if (arg == "-o" && i+1 < argc) opt.outDir = argv[++i];
+    else if (arg == "-n" && i+1 < argc) opt.ntuple = argv[++i];
+    else if (arg == "--offset" && i+1 < argc) opt.offset = std::atoll(argv[++i]);
+    else if (arg == "--h1" && i+1 < argc) opt.h1.push_back(argv[++i]);
+    else if (arg == "--h2" && i+1 < argc) opt.h2.push_back(argv[++i]);
+    else if (arg[0] == '-') {
+      PrintUsage();
+      return 1;
+    }
+    else opt.files.push_back(arg);
+  }
+  if (opt.files.empty() || opt.offset <= 0) {
+    PrintUsage();
+    return 1;
+  }
+  if (opt.nThreads < 1) opt.nThreads = 1;
+#ifndef G4MULTITHREADED
+  // Without multithreading the reader is a single instance, not one per
+  // thread
+  opt.nThreads = 1;
+#endif
+  if (opt.nThreads > opt.files.size()) opt.nThreads = opt.files.size();
+  mkdir(opt.outDir.c_str(), 0755);
+  if (!opt.h1.empty() || !opt.h2.empty()) MergeHistograms(opt);
+  if (opt.ntuple == "none") return 0;
+
+  // Every thread takes the next file until none is left. The Geant4 reader
+  // has one instance per thread; a thread ID marks the threads as workers
+  // so that they do not all claim the master instance.
+  std::vector<long long> nRows(opt.files.size(), -1);
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < opt.nThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      G4Threading::G4SetThreadId(t);
+      size_t count;
+      while ((count = next++) < opt.files.size()) {
+        nRows[count] = MergeFile(opt, count);
+      }
+      delete G4RootAnalysisReader::Instance();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  long long nTotal = 0;
+  for (auto n : nRows) if (n > 0) nTotal += n;
+  WriteMerged(opt, nRows, nTotal);
+  std::cout << "Merged " << nTotal << " rows into " << opt.outDir << "/"
+            << opt.ntuple << ".col" << std::endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,135 @@
+/// \file navbench.cc
+/// \brief Navigation benchmark of the boolean and the placed geometry
+///
+/// Builds the geometry in both modes and moves neutron-like random walks
+/// from the source point through it with a G4Navigator only, no physics:
+/// steps are limited by an exponential free path scaled with the density
+/// of the current material (3 cm in water), or by the next boundary, and
+/// the direction is redrawn isotropically after each physics-limited step.
+/// Prints the navigation time per step for each mode. Both modes use the
+/// same random sequence.
+///
+///   navBench [nHistories]
+
+#include "DetectorConstruction.hh"
+
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4UIcommand.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+
+  G4ThreeVector IsotropicDirection()
+  {
+    G4double cosTheta = 1. - 2.*G4UniformRand();
+    G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    G4double phi = twopi*G4UniformRand();
+    return G4ThreeVector(sinTheta*std::cos(phi), sinTheta*std::sin(phi),
+                         cosTheta);
+  }
+
+  struct Result {
+    long long nSteps = 0;
+    double seconds = 0.;
+  };
+
+  Result RandomWalks(G4VPhysicalVolume* world, G4int nHistories)
+  {
+    const G4ThreeVector source(0., 52.5*cm, 40.*cm);
+    const G4double waterPath = 3.*cm;
+    const G4int maxSteps = 1000;
+
+    G4Navigator navigator;
+    navigator.SetWorldVolume(world);
+    CLHEP::HepRandom::setTheSeed(12345);
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (G4int i = 0; i < nHistories; ++i) {
+      G4ThreeVector position = source;
+      G4ThreeVector direction = IsotropicDirection();
+      G4VPhysicalVolume* volume
+        = navigator.LocateGlobalPointAndSetup(position, &direction,
+                                              false, false);
+      for (G4int step = 0; volume && step < maxSteps; ++step) {
+        G4double density = volume->GetLogicalVolume()->GetMaterial()
+                             ->GetDensity()/(g/cm3);
+        G4double freePath = -waterPath/density*std::log(1. - G4UniformRand());
+        G4double safety;
+        G4double geometryStep
+          = navigator.ComputeStep(position, direction, freePath, safety);
+        ++result.nSteps;
+        if (geometryStep <= freePath) {
+          position += geometryStep*direction;
+          navigator.SetGeometricallyLimitedStep();
+          volume = navigator.LocateGlobalPointAndSetup(position, &direction,
+                                                       true);
+        }
+        else {
+          position += freePath*direction;
+          navigator.LocateGlobalPointWithinVolume(position);
+          direction = IsotropicDirection();
+        }
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    return result;
+  }
+
+  void CleanGeometry()
+  {
+    G4GeometryManager::GetInstance()->OpenGeometry();
+    G4PhysicalVolumeStore::Clean();
+    G4LogicalVolumeStore::Clean();
+    G4SolidStore::Clean();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  G4int nHistories = 100000;
+  if (argc > 1) nHistories = G4UIcommand::ConvertToInt(argv[1]);
+
+  auto detector = new DetectorConstruction();
+  const GeometryMode modes[2] = { GeometryMode::Boolean, GeometryMode::Placed };
+  const char* names[2] = { "boolean", "placed" };
+  double nsPerStep[2];
+  for (G4int i = 0; i < 2; ++i) {
+    detector->SetGeometryMode(modes[i]);
+    G4VPhysicalVolume* world = detector->Construct();
+    // Voxelise as the run manager would before the first event
+    G4GeometryManager::GetInstance()->CloseGeometry(true, false, world);
+
+    Result result = RandomWalks(world, nHistories);
+    nsPerStep[i] = 1e9*result.seconds/result.nSteps;
+    G4cout << std::setw(8) << names[i] << " : " << result.nSteps
+           << " steps in " << result.seconds << " s, "
+           << nsPerStep[i] << " ns/step" << G4endl;
+    CleanGeometry();
+  }
+  G4cout << "placed/boolean time per step: " << nsPerStep[1]/nsPerStep[0]
+         << G4endl;
+
+  delete detector;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -1,11 +1,32 @@
 #!/bin/bash
+# Start an N-shard job. Every shard gets its own random stream derived from
+# SEED and its share of TOTAL events.
+# Rerunning with the same SEED reproduces the job exactly.
+# Shards write out/run_<k>_seg<j>.root segments of CHECKPOINT events and
+# out/run_<k>.ckpt; rerunning a killed shard resumes it.
+# With an _HP physics list every process reads the neutron data; its worker
+# threads share them, so run fewer shards with more THREADS each.
 
 MC_HOME='.'
-for i in $(seq 1 100)
+NSHARDS=${NSHARDS:-100}
+TOTAL=${TOTAL:-1000000000}
+SEED=${SEED:-20201117}
+GDML=${GDML:-out/geometry.gdml}
+CHECKPOINT=${CHECKPOINT:-100000}
+TABLES=${TABLES:-out/physics}
+PHYSICS=${PHYSICS:-QBBC}
+THREADS=${THREADS:-1}
+
+# Check the geometry for overlaps once; the shards read it without checks
+$MC_HOME/build/toyMC_batch --gdml-export $GDML || exit 1
+# Build the physics tables once; the shards retrieve them
+$MC_HOME/build/toyMC_batch --gdml $GDML --physics-list $PHYSICS \
+  --store-physics-tables $TABLES || exit 1
+for i in $(seq 0 $((NSHARDS-1)))
   do
-    export Filename='out/'$i
     export Logfile='out/log'$i'.txt'
-    $MC_HOME/build/toyMC run1.mac $Filename i >$Logfile &
-    echo "$i" 
+    $MC_HOME/build/toyMC_batch -t $THREADS --shard $i/$NSHARDS --seed $SEED \
+      --events $TOTAL --checkpoint $CHECKPOINT --gdml $GDML \
+      --physics-list $PHYSICS --physics-tables $TABLES run1.mac out/run >$Logfile &
+    echo "$i"
   done
-
@@ -5,7 +5,9 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "StackingAction.hh"
 #include "SteppingAction.hh"
+#include "TrackingAction.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -22,8 +24,8 @@ ActionInitialization::~ActionInitialization()
 
 void ActionInitialization::BuildForMaster() const
 {
-  RunAction* runAction = new RunAction;
-  runAction->SetDataFilenamemy(m_hDataFilename);
+  RunAction* runAction = new RunAction(fOutputMode);
+  ConfigureRunAction(runAction);
   SetUserAction(runAction);
 }
 
@@ -33,14 +35,31 @@ void ActionInitialization::Build() const
 {
   SetUserAction(new PrimaryGeneratorAction);
 
-  RunAction* runAction = new RunAction;
-  runAction->SetDataFilenamemy(m_hDataFilename);
+  RunAction* runAction = new RunAction(fOutputMode);
+  ConfigureRunAction(runAction);
   SetUserAction(runAction);
   
+  // The other actions share the state of the run action of their thread
   EventAction* eventAction = new EventAction(runAction);
   SetUserAction(eventAction);
-  
-  SetUserAction(new SteppingAction(eventAction));
+
+  SetUserAction(new StackingAction(runAction->GetKillPolicy(),
+                                   runAction->GetSecondaries()));
+  SetUserAction(new TrackingAction(runAction));
+  SetUserAction(new SteppingAction(runAction));
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ActionInitialization::ConfigureRunAction(RunAction* runAction) const
+{
+  // The same settings for the master and the workers; in a sequential
+  // build the run action of Build() is the master's
+  runAction->SetDataFilenamemy(m_hDataFilename);
+  runAction->SetShard(fShard);
+  runAction->SetCheckpointInterval(fCheckpointInterval);
+  runAction->SetBenchmark(fBenchFile, fBenchName);
+  runAction->SetPhysicsListName(fPhysicsListName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,47 @@
+/// \file AliasTable.cc
+/// \brief Implementation of the AliasTable class
+
+#include "AliasTable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AliasTable::Build(const std::vector<G4double>& weights)
+{
+  size_t n = weights.size();
+  G4double sum = 0.;
+  for (G4double w : weights) sum += w;
+
+  fPdf.assign(n, 0.);
+  fProbability.assign(n, 1.);
+  fAlias.resize(n);
+  if (n == 0 || sum <= 0.) return;
+
+  // Scaled weights: mean 1. Bins below 1 get the rest of their column
+  // from a bin above 1.
+  std::vector<G4double> scaled(n);
+  std::vector<size_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    fPdf[i] = weights[i]/sum;
+    scaled[i] = fPdf[i]*n;
+    fAlias[i] = i;
+    if (scaled[i] < 1.) small.push_back(i);
+    else large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    size_t s = small.back();
+    small.pop_back();
+    size_t l = large.back();
+    fProbability[s] = scaled[s];
+    fAlias[s] = l;
+    scaled[l] -= 1. - scaled[s];
+    if (scaled[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Left overs are 1 up to rounding
+  for (size_t i : small) fProbability[i] = 1.;
+  for (size_t i : large) fProbability[i] = 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,123 @@
+/// \file CheckpointManager.cc
+/// \brief Implementation of the CheckpointManager class
+
+#include "CheckpointManager.hh"
+#include "ProgressMonitor.hh"
+
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager::CheckpointManager(const G4String& fileName, G4int interval)
+ : fMessenger(0),
+   fFileName(fileName),
+   fInterval(interval)
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/run/", "Runs with checkpoints");
+
+  auto& beamOnCmd
+    = fMessenger->DeclareMethod("beamOn", &CheckpointManager::BeamOn,
+        "As /run/beamOn, in checkpointed segments with toyMC --checkpoint.");
+  beamOnCmd.SetParameterName("nEvents", false);
+  beamOnCmd.SetRange("nEvents>=0");
+  beamOnCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager::~CheckpointManager()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::BeamOn(G4int nEvents)
+{
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+  if (fInterval <= 0) {
+    ProgressMonitor::SetJob(nEvents, 0);
+    runManager->BeamOn(nEvents);
+    return;
+  }
+
+  G4int nSegments = (nEvents + fInterval - 1)/fInterval;
+  G4int first = Restore(nEvents);
+  // The run ID numbers the segment files and offsets the event IDs
+  runManager->SetRunIDCounter(first);
+  for (G4int segment = first; segment < nSegments; ++segment) {
+    G4int n = std::min(fInterval, nEvents - segment*fInterval);
+    G4cout << "Segment " << segment + 1 << "/" << nSegments << ": events "
+           << segment*fInterval << " - " << segment*fInterval + n - 1
+           << G4endl;
+    ProgressMonitor::SetJob(nEvents, segment*fInterval);
+    runManager->BeamOn(n);
+    Save(nEvents, segment + 1);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int CheckpointManager::Restore(G4int nEvents)
+{
+  std::ifstream in(fFileName);
+  if (!in) return 0;
+
+  G4String tag;
+  G4int version = 0, savedEvents = 0, interval = 0, nSegmentsDone = 0;
+  in >> tag >> version >> savedEvents >> interval >> nSegmentsDone;
+  if (!in || tag != "toyMC-checkpoint" || version != 1
+      || savedEvents != nEvents || interval != fInterval) {
+    G4ExceptionDescription msg;
+    msg << fFileName << " does not belong to this job (" << nEvents
+        << " events in segments of " << fInterval << "), starting over.";
+    G4Exception("CheckpointManager::Restore()", "toyMC001", JustWarning,
+                msg);
+    return 0;
+  }
+  G4Random::getTheEngine()->get(in);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read the random engine state from " << fFileName
+        << ", starting over.";
+    G4Exception("CheckpointManager::Restore()", "toyMC001", JustWarning,
+                msg);
+    return 0;
+  }
+  G4cout << "Resuming from " << fFileName << " after " << nSegmentsDone
+         << " segments (" << std::min(nEvents, nSegmentsDone*fInterval)
+         << " events)" << G4endl;
+  return nSegmentsDone;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::Save(G4int nEvents, G4int nSegmentsDone)
+{
+  // Write a new file and rename it, so that a job killed while saving
+  // still finds the previous checkpoint
+  G4String tmpName = fFileName + ".tmp";
+  {
+    std::ofstream out(tmpName);
+    out << "toyMC-checkpoint 1 " << nEvents << " " << fInterval << " "
+        << nSegmentsDone << "\n";
+    G4Random::getTheEngine()->put(out);
+    out << "\n";
+    if (!out) {
+      G4ExceptionDescription msg;
+      msg << "Cannot write the checkpoint " << tmpName;
+      G4Exception("CheckpointManager::Save()", "toyMC001", JustWarning, msg);
+      return;
+    }
+  }
+  std::rename(tmpName.c_str(), fFileName.c_str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
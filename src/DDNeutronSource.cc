@@ -0,0 +1,166 @@
+/// \file DDNeutronSource.cc
+/// \brief Implementation of the DDNeutronSource class
+
+#include "DDNeutronSource.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DDNeutronSource::DDNeutronSource()
+ : fMessenger(0),
+   fPosition(0., 52.5*cm, 40.*cm),
+   fBeamAxis(0., 0., 1.)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DDNeutronSource::~DDNeutronSource()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DDNeutronSource::LoadTable(const G4String& fileName)
+{
+  std::ifstream in(fileName);
+  if (!in) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read the DD source table " << fileName;
+    G4Exception("DDNeutronSource::LoadTable()", "toyMC003", FatalException,
+                msg);
+    return;
+  }
+
+  // thetaLow thetaHigh [deg] eLow eHigh [MeV] yield, '#' comments
+  struct EnergyBin { G4double eLow, eHigh, yield; };
+  std::map<std::pair<G4double, G4double>, std::vector<EnergyBin>> bins;
+  std::string line;
+  G4int lineNumber = 0;
+  while (std::getline(in, line)) {
+    ++lineNumber;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    G4double thetaLow, thetaHigh;
+    EnergyBin bin;
+    if (!(fields >> thetaLow >> thetaHigh >> bin.eLow >> bin.eHigh
+                 >> bin.yield)) {
+      G4ExceptionDescription msg;
+      msg << fileName << ":" << lineNumber << ": expected thetaLow thetaHigh"
+          << " eLow eHigh yield.";
+      G4Exception("DDNeutronSource::LoadTable()", "toyMC003", FatalException,
+                  msg);
+      return;
+    }
+    bins[std::make_pair(thetaLow, thetaHigh)].push_back(bin);
+  }
+
+  fAngleBins.clear();
+  std::vector<G4double> angleYields;
+  for (const auto& item : bins) {
+    AngleBin angleBin;
+    angleBin.cosLow = std::cos(item.first.second*deg);
+    angleBin.cosHigh = std::cos(item.first.first*deg);
+    std::vector<G4double> yields;
+    G4double sum = 0.;
+    for (const auto& bin : item.second) {
+      angleBin.eLow.push_back(bin.eLow*MeV);
+      angleBin.eHigh.push_back(bin.eHigh*MeV);
+      yields.push_back(bin.yield);
+      sum += bin.yield;
+    }
+    angleBin.energy.Build(yields);
+    fAngleBins.push_back(angleBin);
+    angleYields.push_back(sum);
+  }
+  fAngle.Build(angleYields);
+  G4cout << "DD source: " << fAngleBins.size() << " angle bins read from "
+         << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector DDNeutronSource::SampleDirection(size_t& angleBin) const
+{
+  angleBin = fAngle.Sample(G4UniformRand());
+  const AngleBin& bin = fAngleBins[angleBin];
+  G4double cosTheta
+    = bin.cosLow + (bin.cosHigh - bin.cosLow)*G4UniformRand();
+  G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+  G4double phi = twopi*G4UniformRand();
+  G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi),
+                          cosTheta);
+  return direction.rotateUz(fBeamAxis.unit());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+size_t DDNeutronSource::FindBin(const G4ThreeVector& direction) const
+{
+  // Bins are ordered by angle, i.e. by decreasing cosine; the table need
+  // not cover 0-180 deg, nor be without gaps. First bin reaching down to
+  // the cosine, then whether it also reaches up to it.
+  G4double cosTheta = direction.dot(fBeamAxis.unit());
+  auto bin = std::upper_bound(fAngleBins.begin(), fAngleBins.end(), cosTheta,
+                              [](G4double value, const AngleBin& angleBin)
+                              { return value >= angleBin.cosLow; });
+  if (bin == fAngleBins.end() || cosTheta > bin->cosHigh) return NoBin();
+  return bin - fAngleBins.begin();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DDNeutronSource::SampleEnergy(size_t angleBin) const
+{
+  const AngleBin& bin = fAngleBins[angleBin];
+  size_t i = bin.energy.Sample(G4UniformRand());
+  return bin.eLow[i] + (bin.eHigh[i] - bin.eLow[i])*G4UniformRand();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DDNeutronSource::AngularDensity(size_t i) const
+{
+  if (i == NoBin()) return 0.;
+  const AngleBin& bin = fAngleBins[i];
+  G4double solidAngle = twopi*(bin.cosHigh - bin.cosLow);
+  return solidAngle > 0. ? fAngle.Probability(i)/solidAngle : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DDNeutronSource::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/dd/", "DD neutron source");
+
+  auto& tableCmd
+    = fMessenger->DeclareMethod("table", &DDNeutronSource::LoadTable,
+        "Read the angle-energy table and use the DD source instead of the"
+        " GPS.");
+  tableCmd.SetParameterName("file", false);
+
+  auto& positionCmd
+    = fMessenger->DeclarePropertyWithUnit("position", "cm", fPosition,
+        "Position of the point source.");
+  positionCmd.SetParameterName("x", "y", "z", false);
+
+  auto& axisCmd
+    = fMessenger->DeclareProperty("beamAxis", fBeamAxis,
+        "Direction of the deuteron beam, angles are measured from it.");
+  axisCmd.SetParameterName("x", "y", "z", false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
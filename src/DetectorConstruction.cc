@@ -2,6 +2,9 @@
 /// \brief Implementation of the DetectorConstruction class
 
 #include "DetectorConstruction.hh"
+#include "DetectorSD.hh"
+#include "StartupTimer.hh"
+#include "DetectorRegions.hh"
 
 #include "G4RunManager.hh"
 #include "G4NistManager.hh"
@@ -11,6 +14,7 @@
 #include "G4Sphere.hh"
 #include "G4Trd.hh"
 #include <G4Tubs.hh>
+#include <G4CutTubs.hh>
 #include <G4RotationMatrix.hh>
 #include <G4ThreeVector.hh>
 #include <G4UnionSolid.hh>
@@ -18,22 +22,88 @@
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4SDManager.hh"
 #include <G4VisAttributes.hh>
+#include "G4LogicalVolumeStore.hh"
+#include "G4BOptrForceCollision.hh"
+#include "G4GenericMessenger.hh"
+#include "G4StateManager.hh"
+#ifdef G4LIB_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
 
 #define pi 3.14159265359
 
+namespace {
+  // Dimensions shared by the boolean and the placed geometry
+  const G4double ContainerSize = 50*cm;
+  const G4double ScintillatorSize = 7.62*cm;
+  const G4double GuidePipeTubHalfLength = 0.5*m;
+  const G4double GuidePipeTubOutRaius = 5*cm;
+  const G4double GuidePipeTubInnerRaius = 4.5*cm;
+  const G4double BeamPipeTubHalfLength = 1*m;
+  const G4double BeamPipeTubOutRaius = 5*cm;
+  const G4double BeamPipeTubInnerRaius = 4.5*cm;
+  const G4double DetectorTubHalfLength = 5*cm;
+
+  // The guide pipe starts on the axis at (0, ContainerSize/4, 0) and has to
+  // leave the box through its +y face, (ContainerSize/4)*cot(angle) <=
+  // ContainerSize/2, with the part outside longer than the slant of its cut
+  // face (see ConstructPlaced)
+  G4bool GuidePipeFits(G4double angle)
+  {
+    G4double s0 = 0.25*ContainerSize/std::sin(angle);
+    G4double halfLength = GuidePipeTubHalfLength - 0.5*s0;
+    return std::cos(angle) <= 2*std::sin(angle)
+           && halfLength > GuidePipeTubOutRaius/std::tan(angle);
+  }
+
+  // Smallest angle which fits; both conditions only get easier with the
+  // angle
+  G4double MinGuidePipeAngle()
+  {
+    G4double low = 0.;
+    G4double high = 90.*deg;
+    for (G4int i = 0; i < 50; ++i) {
+      G4double mid = 0.5*(low + high);
+      if (GuidePipeFits(mid)) high = mid;
+      else low = mid;
+    }
+    return high;
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::DetectorConstruction()
-: G4VUserDetectorConstruction()
+: G4VUserDetectorConstruction(),
+  fScoringVolume(nullptr),
+  fGeometryMode(GeometryMode::Boolean),
+  fCheckOverlaps(true),
+  fForceCollision(false),
+  fMessenger(nullptr),
+  fScintillatorMaterial("HeavyWater"),
+  fDetectorOffset(0.6*ScintillatorSize),
+  fGuidePipeAngle(45.*deg),
+  fModified(false),
+  Air(nullptr), Water(nullptr), EJ276(nullptr), EJ315(nullptr),
+  SS304LSteel(nullptr), C6D8(nullptr), HeavyWater(nullptr)
 {
-  DefineMaterial();
+  // Materials are defined when the geometry is built from code; a GDML
+  // file brings its own
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::~DetectorConstruction()
-{ }
+{
+  delete fMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 void DetectorConstruction::DefineMaterial()
@@ -120,13 +190,30 @@ void DetectorConstruction::DefineMaterial()
 }
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {  
-  
+  if (!fGdmlFile.empty()) {
+#ifdef G4LIB_USE_GDML
+    // No overlap checks: the file was validated when it was exported
+    G4GDMLParser parser;
+    parser.SetOverlapCheck(false);
+    parser.Read(fGdmlFile, false);
+    G4cout << "Geometry read from " << fGdmlFile << G4endl;
+    G4VPhysicalVolume* world = parser.GetWorldVolume();
+    DetectorRegions::AssignVolumes();
+    StartupTimer::Mark("geometry");
+    return world;
+#else
+    G4Exception("DetectorConstruction::Construct()", "toyMC002",
+                FatalException, "Geant4 was built without GDML support");
+#endif
+  }
+  if (!Air) DefineMaterial();
+  StartupTimer::Mark("materials");
   // Env is water tank
   //
   G4double env_sizeXY = 3*m, env_sizeZ = 5*m;
   // Option to switch on/off checking of volumes overlaps
   //
-  G4bool checkOverlaps = true;
+  G4bool checkOverlaps = fCheckOverlaps;
  
   // World
   G4double world_sizeXY = 1.2*env_sizeXY;
@@ -170,10 +257,14 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     false,                   //no boolean operation
                     0,                       //copy number
                     checkOverlaps);          //overlaps checking  
+  if (fGeometryMode == GeometryMode::Placed) {
+    ConstructPlaced(logicEnv, checkOverlaps);
+    DetectorRegions::AssignVolumes();
+    StartupTimer::Mark("geometry");
+    return physWorld;
+  }
   // Container=====================================================================
   G4ThreeVector pos1 = G4ThreeVector(0, 0, 0);
-  G4double ContainerSize = 50*cm;
-  G4double ScintillatorSize = 7.62*cm;
 
   G4Box* Container =    
     new G4Box("Container",                       //its name
@@ -193,10 +284,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     0,                       //copy number
                     checkOverlaps);          //overlaps checking*/  
   //GuidePipe===============================================================
-  G4double GuidePipeTubHalfLength = 0.5*m;
-  G4double GuidePipeTubOutRaius = 5*cm;
-  G4double GuidePipeTubInnerRaius = 4.5*cm;
-  G4ThreeVector pos2 = G4ThreeVector(0,GuidePipeTubHalfLength*sin(pi/4) + 0.25*ContainerSize,GuidePipeTubHalfLength*sin(pi/4));
+  G4ThreeVector pos2 = G4ThreeVector(0,GuidePipeTubHalfLength*sin(fGuidePipeAngle) + 0.25*ContainerSize,GuidePipeTubHalfLength*cos(fGuidePipeAngle));
   G4Tubs *GuidePipeTub =
     new G4Tubs("GuidePipeTub", 0. * cm, GuidePipeTubOutRaius,
                GuidePipeTubHalfLength, 0. * deg, 360. * deg);
@@ -211,8 +299,8 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                         SS304LSteel,          //its material
                         "SteelGuidePipeTub");           //its name
   G4RotationMatrix *GuidePipeRot = new G4RotationMatrix;
-  GuidePipeRot->rotateX(45.*deg);
-  new G4PVPlacement(GuidePipeRot,            //rotate 45 degree on X
+  GuidePipeRot->rotateX(fGuidePipeAngle);
+  new G4PVPlacement(GuidePipeRot,            //rotate guide pipe angle on X
                     pos2,                    //at position
                     logicSteelGuidePipeTub,             //its logical volume
                     "SteelGuidePipeTub",                //its name
@@ -236,10 +324,9 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   //========================================================================
 
   //BeamPipe================================================================
-  G4double BeamPipeTubHalfLength = 1*m;
-  G4double BeamPipeTubOutRaius = 5*cm;
-  G4double BeamPipeTubInnerRaius = 4.5*cm;
-  G4ThreeVector pos3 = G4ThreeVector(0,0,BeamPipeTubHalfLength + 0.6*ScintillatorSize);
+  // The beam pipe starts at the detector offset, DetectorTub moves with it
+  G4ThreeVector pos3 = G4ThreeVector(0,0,BeamPipeTubHalfLength + fDetectorOffset);
+  G4double detectorShift = fDetectorOffset - 0.6*ScintillatorSize;
   G4Tubs *BeamPipeTub =
     new G4Tubs("BeamPipeTub", 0. * cm, BeamPipeTubOutRaius,
                BeamPipeTubHalfLength, 0. * deg, 360. * deg);
@@ -248,7 +335,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                BeamPipeTubHalfLength, 0. * deg, 360. * deg);
   G4Tubs *DetectorTub =
     new G4Tubs("DetectorTub", 0. * cm, BeamPipeTubInnerRaius,
-               5*cm, 0. * deg, 360. * deg);
+               DetectorTubHalfLength, 0. * deg, 360. * deg);
   G4VSolid *SteelBeamPipeTub =
     new G4SubtractionSolid("SteelBeamPipeTub", BeamPipeTub, AirBeamPipeTub,
                            0, G4ThreeVector());
@@ -294,7 +381,7 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   logicAirTee->SetVisAttributes(DetectorVisAtt);
 
   new G4PVPlacement(0,            
-                    G4ThreeVector(0,0,BeamPipeTubHalfLength),        //at center of BeamPipe
+                    G4ThreeVector(0,0,BeamPipeTubHalfLength + detectorShift),        //at center of BeamPipe
                     logicDetectorTub,             //its logical volume
                     "DetectorTub",                //its name
                     logicAirTee,      //its mother  volume
@@ -302,21 +389,48 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     0,                       //copy number
                     checkOverlaps);
   //========================================================================
+  PlaceScintillator(logicAirTee, G4ThreeVector(0,0,-5*cm), checkOverlaps);
+  //===============================================================
+  DetectorRegions::AssignVolumes();
+  StartupTimer::Mark("geometry");
+  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::PlaceScintillator(G4LogicalVolume* mother,
+                                             const G4ThreeVector& pos,
+                                             G4bool checkOverlaps)
+{
   //scintillator===============================================================     
+  // Any material defined in DefineMaterial, or a NIST material
+  G4Material* material = G4Material::GetMaterial(fScintillatorMaterial, false);
+  if (!material) {
+    material = G4NistManager::Instance()->FindOrBuildMaterial(
+                 fScintillatorMaterial, false, false);
+  }
+  if (!material) {
+    G4ExceptionDescription msg;
+    msg << "Scintillator material " << fScintillatorMaterial
+        << " not found, using HeavyWater.";
+    G4Exception("DetectorConstruction::PlaceScintillator()", "toyMC001",
+                JustWarning, msg);
+    material = HeavyWater;
+  }
   G4Tubs* Scintillator =    
     new G4Tubs("Scintillator",                       //its name
        0 * cm, 0.5*ScintillatorSize, 0.5*ScintillatorSize,0. * deg, 360. * deg);     //its size
                       
   G4LogicalVolume* logicScintillator =                         
     new G4LogicalVolume(Scintillator,         //its solid
-                        HeavyWater,          //its material
+                        material,          //its material
                         "Scintillator");           //its name
                
   new G4PVPlacement(0,                       //no rotation
-                    G4ThreeVector(0,0,-5*cm),       //at position
+                    pos,                     //at position
                     logicScintillator,             //its logical volume
                     "Scintillator",                //its name
-                    logicAirTee,                //its mother volume  is contanier
+                    mother,                  //its mother volume  is contanier
                     false,                   //no boolean operation
                     0,                       //copy number
                     checkOverlaps);          //overlaps checking
@@ -327,8 +441,307 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   ScintillatorVisAtt->SetForceAuxEdgeVisible(true);
   logicScintillator->SetVisAttributes(
     ScintillatorVisAtt);
-  //===============================================================
-  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructPlaced(G4LogicalVolume* logicEnv,
+                                           G4bool checkOverlaps)
+{
+  // Same setup as the AirTee union, from placed primitives only: the air
+  // box, and the parts of the pipes outside of it as steel tubes with air
+  // daughters. The pipes start at the faces of the box; in the boolean
+  // geometry their steel walls also reached into the box, overlapping
+  // the air. The guide pipe is cut by a G4CutTubs along the face it
+  // crosses at 45 degree.
+  G4VisAttributes* AirVisAtt= new G4VisAttributes(G4Colour(1.0,1.0,.0,0.3));  //set translucent
+
+  // Container=====================================================================
+  G4Box* Container =
+    new G4Box("Container",                       //its name
+       0.5*ContainerSize, 0.5*ContainerSize, 0.5*ContainerSize);     //its size
+  G4LogicalVolume* logicContainer =
+    new G4LogicalVolume(Container,         //its solid
+                        Air,          //its material
+                        "Container");           //its name
+  new G4PVPlacement(0,                       //no rotation
+                    G4ThreeVector(),         //at (0,0,0)
+                    logicContainer,             //its logical volume
+                    "Container",                //its name
+                    logicEnv,                //its mother  volume
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);          //overlaps checking
+  logicContainer->SetVisAttributes(AirVisAtt);
+
+  //GuidePipe===============================================================
+  // Axis from (0, ContainerSize/4, 0) along (0, sin, cos) of the angle;
+  // the part beyond the +y face of the box starts at s0 along the axis
+  G4double angle = fGuidePipeAngle;
+  G4ThreeVector axis(0, std::sin(angle), std::cos(angle));
+  G4ThreeVector lowEnd(0, 0.25*ContainerSize, 0);
+  G4double s0 = 0.25*ContainerSize/std::sin(angle);
+  G4double GuideHalfLength = GuidePipeTubHalfLength - 0.5*s0;
+  G4ThreeVector pos2 = lowEnd + (s0 + GuideHalfLength)*axis;
+  G4RotationMatrix *GuidePipeRot = new G4RotationMatrix;
+  GuidePipeRot->rotateX(angle);
+  // The face of the box is y = ContainerSize/2, normal (0,-1,0) seen from
+  // the pipe; in the frame of the pipe
+  G4ThreeVector lowNorm(0, -std::cos(angle), -std::sin(angle));
+  G4ThreeVector highNorm(0, 0, 1);
+  G4CutTubs *SteelGuidePipeTub =
+    new G4CutTubs("SteelGuidePipeTub", 0. * cm, GuidePipeTubOutRaius,
+                  GuideHalfLength, 0. * deg, 360. * deg, lowNorm, highNorm);
+  G4CutTubs *AirGuidePipeTub =
+    new G4CutTubs("AirGuidePipeTub", 0. * cm, GuidePipeTubInnerRaius,
+                  GuideHalfLength, 0. * deg, 360. * deg, lowNorm, highNorm);
+  G4LogicalVolume* logicSteelGuidePipeTub =
+    new G4LogicalVolume(SteelGuidePipeTub,         //its solid
+                        SS304LSteel,          //its material
+                        "SteelGuidePipeTub");           //its name
+  new G4PVPlacement(GuidePipeRot,            //rotate guide pipe angle on X
+                    pos2,                    //at position
+                    logicSteelGuidePipeTub,             //its logical volume
+                    "SteelGuidePipeTub",                //its name
+                    logicEnv,                //its mother  volume
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);
+  G4LogicalVolume* logicAirGuidePipeTub =
+    new G4LogicalVolume(AirGuidePipeTub,         //its solid
+                        Air,          //its material
+                        "AirGuidePipeTub");           //its name
+  new G4PVPlacement(0,                       //no rotation relative to steel tub
+                    G4ThreeVector(),         //at center of steel tub
+                    logicAirGuidePipeTub,             //its logical volume
+                    "AirGuidePipeTub",                //its name
+                    logicSteelGuidePipeTub,                //its mother volume (Steel tub)
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);
+  logicAirGuidePipeTub->SetVisAttributes(AirVisAtt);
+
+  //BeamPipe================================================================
+  // From the +z face of the box to the end of the pipe
+  G4double beamLow = 0.5*ContainerSize;
+  G4double beamHigh = 2*BeamPipeTubHalfLength + fDetectorOffset;
+  G4double detectorShift = fDetectorOffset - 0.6*ScintillatorSize;
+  G4double BeamHalfLength = 0.5*(beamHigh - beamLow);
+  G4ThreeVector pos3 = G4ThreeVector(0,0,beamLow + BeamHalfLength);
+  G4Tubs *SteelBeamPipeTub =
+    new G4Tubs("SteelBeamPipeTub", 0. * cm, BeamPipeTubOutRaius,
+               BeamHalfLength, 0. * deg, 360. * deg);
+  G4Tubs *AirBeamPipeTub =
+    new G4Tubs("AirBeamPipeTub", 0. * cm, BeamPipeTubInnerRaius,
+               BeamHalfLength, 0. * deg, 360. * deg);
+  G4LogicalVolume* logicSteelBeamPipeTub =
+    new G4LogicalVolume(SteelBeamPipeTub,         //its solid
+                        SS304LSteel,          //its material
+                        "SteelBeamPipeTub");           //its name
+  new G4PVPlacement(0,
+                    pos3,                    //at position
+                    logicSteelBeamPipeTub,             //its logical volume
+                    "SteelBeamPipeTub",                //its name
+                    logicEnv,                //its mother  volume
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);
+  G4LogicalVolume* logicAirBeamPipeTub =
+    new G4LogicalVolume(AirBeamPipeTub,         //its solid
+                        Air,          //its material
+                        "AirBeamPipeTub");           //its name
+  new G4PVPlacement(0,                       //no rotation relative to steel tub
+                    G4ThreeVector(),         //at center of steel tub
+                    logicAirBeamPipeTub,             //its logical volume
+                    "AirBeamPipeTub",                //its name
+                    logicSteelBeamPipeTub,                //its mother volume (Steel tub)
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);
+  logicAirBeamPipeTub->SetVisAttributes(AirVisAtt);
+
+  // DetectorTub at z = BeamPipeTubHalfLength (+ shift), as in the AirTee
+  G4Tubs *DetectorTub =
+    new G4Tubs("DetectorTub", 0. * cm, BeamPipeTubInnerRaius,
+               DetectorTubHalfLength, 0. * deg, 360. * deg);
+  G4LogicalVolume* logicDetectorTub =
+    new G4LogicalVolume(DetectorTub,         //its solid
+                        Water,          //its material
+                        "DetectorTub");           //its name
+  new G4PVPlacement(0,
+                    G4ThreeVector(0,0,BeamPipeTubHalfLength + detectorShift
+                                      - pos3.z()),
+                    logicDetectorTub,             //its logical volume
+                    "DetectorTub",                //its name
+                    logicAirBeamPipeTub,      //its mother  volume
+                    false,                   //no boolean operation
+                    0,                       //copy number
+                    checkOverlaps);
+  //========================================================================
+  PlaceScintillator(logicContainer, G4ThreeVector(0,0,-5*cm), checkOverlaps);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ExportGdml(const G4String& fileName)
+{
+#ifdef G4LIB_USE_GDML
+  fGdmlFile = "";
+  fCheckOverlaps = true;
+  G4VPhysicalVolume* world = Construct();
+  // The GDML writer refuses to overwrite a file
+  std::remove(fileName.c_str());
+  G4GDMLParser parser;
+  parser.Write(fileName, world);
+#else
+  G4Exception("DetectorConstruction::ExportGdml()", "toyMC002",
+              FatalException, "Geant4 was built without GDML support");
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetScintillatorMaterial(const G4String& name)
+{
+  fScintillatorMaterial = name;
+  GeometryModified();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetDetectorOffset(G4double offset)
+{
+  // The beam pipe must stay clear of the Scintillator
+  if (offset < 0.5*ScintillatorSize) {
+    G4ExceptionDescription msg;
+    msg << "Detector offset " << offset/mm << " mm is inside the"
+        << " Scintillator, ignored.";
+    G4Exception("DetectorConstruction::SetDetectorOffset()", "toyMC001",
+                JustWarning, msg);
+    return;
+  }
+  fDetectorOffset = offset;
+  GeometryModified();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetGuidePipeAngle(G4double angle)
+{
+  static const G4double minAngle = MinGuidePipeAngle();
+  if (angle < minAngle || angle >= 90.*deg) {
+    G4ExceptionDescription msg;
+    msg << "Guide pipe angle " << angle/deg << " deg not in ["
+        << minAngle/deg << ", 90): the pipe has to leave the container"
+        << " through its +y face, ignored.";
+    G4Exception("DetectorConstruction::SetGuidePipeAngle()", "toyMC001",
+                JustWarning, msg);
+    return;
+  }
+  fGuidePipeAngle = angle;
+  GeometryModified();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DetectorConstruction::GetConfigurationTag() const
+{
+  std::ostringstream tag;
+  tag << fScintillatorMaterial << "_" << fGuidePipeAngle/deg << "deg_"
+      << fDetectorOffset/mm << "mm";
+  return tag.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::GeometryModified()
+{
+  // A GDML geometry is not changed, its files are not tagged
+  if (!fGdmlFile.empty()) {
+    G4Exception("DetectorConstruction::GeometryModified()", "toyMC001",
+                JustWarning, "The geometry is read from GDML, /toy/det/"
+                " commands have no effect.");
+    return;
+  }
+  fModified = true;
+  // Between runs: the next run rebuilds the geometry (on the workers too)
+  // and keeps the physics tables of the materials already used
+  if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+    G4RunManager::GetRunManager()->ReinitializeGeometry(true);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/det/", "Detector configuration");
+
+  // The detector construction exists on the master only
+  auto& materialCmd
+    = fMessenger->DeclareMethod("scintillatorMaterial",
+        &DetectorConstruction::SetScintillatorMaterial,
+        "Scintillator material: HeavyWater (default), EJ276, EJ315, Hexane,"
+        " C6D6, or a NIST material.");
+  materialCmd.SetParameterName("material", false);
+  materialCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  materialCmd.SetToBeBroadcasted(false);
+
+  auto& offsetCmd
+    = fMessenger->DeclareMethodWithUnit("detectorOffset", "cm",
+        &DetectorConstruction::SetDetectorOffset,
+        "Start of the beam pipe with DetectorTub along z (default 4.572 cm).");
+  offsetCmd.SetParameterName("offset", false);
+  offsetCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  offsetCmd.SetToBeBroadcasted(false);
+
+  auto& angleCmd
+    = fMessenger->DeclareMethodWithUnit("guidePipeAngle", "deg",
+        &DetectorConstruction::SetGuidePipeAngle,
+        "Angle of the guide pipe to the beam pipe (default 45 deg).");
+  angleCmd.SetParameterName("angle", false);
+  angleCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  angleCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructSDandField()
+{
+  // Sensitive detectors, one hits collection each. Only steps inside
+  // these volumes reach the user code. After /toy/det/ commands the
+  // geometry is rebuilt and the existing detectors are attached to the
+  // new volumes.
+  //
+  G4SDManager* sdManager = G4SDManager::GetSDMpointer();
+
+  auto detectorSD = sdManager->FindSensitiveDetector("DetectorSD", false);
+  if (!detectorSD) {
+    detectorSD = new DetectorSD("DetectorSD", "DetectorHitsCollection");
+    sdManager->AddNewDetector(detectorSD);
+  }
+  SetSensitiveDetector("DetectorTub", detectorSD);
+
+  auto scintillatorSD
+    = sdManager->FindSensitiveDetector("ScintillatorSD", false);
+  if (!scintillatorSD) {
+    scintillatorSD
+      = new DetectorSD("ScintillatorSD", "ScintillatorHitsCollection");
+    sdManager->AddNewDetector(scintillatorSD);
+  }
+  SetSensitiveDetector("Scintillator", scintillatorSD);
+
+  // Biasing operators are thread local, like the sensitive detectors
+  if (fForceCollision) {
+    static G4ThreadLocal G4BOptrForceCollision* forceCollision = nullptr;
+    if (!forceCollision) {
+      forceCollision
+        = new G4BOptrForceCollision("neutron", "ScintillatorForceCollision");
+    }
+    forceCollision->AttachTo(
+      G4LogicalVolumeStore::GetInstance()->GetVolume("Scintillator"));
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
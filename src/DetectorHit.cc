@@ -0,0 +1,111 @@
+/// \file DetectorHit.cc
+/// \brief Implementation of the DetectorHit class
+
+#include "DetectorHit.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4UnitsTable.hh"
+#include "G4VVisManager.hh"
+#include "G4Circle.hh"
+#include "G4Colour.hh"
+#include "G4VisAttributes.hh"
+
+#include <iomanip>
+
+G4ThreadLocal G4Allocator<DetectorHit>* DetectorHitAllocator = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorHit::DetectorHit()
+ : G4VHit(),
+   fTrackID(-1),
+   fParentID(-1),
+   fParticle(0),
+   fEnergy(0.),
+   fEdep(0.),
+   fTime(0.),
+   fPrePos(G4ThreeVector()),
+   fPostPos(G4ThreeVector()),
+   fInteraction(false),
+   fWeight(1.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorHit::~DetectorHit() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorHit::DetectorHit(const DetectorHit& right)
+  : G4VHit()
+{
+  fTrackID   = right.fTrackID;
+  fParentID  = right.fParentID;
+  fParticle  = right.fParticle;
+  fEnergy    = right.fEnergy;
+  fEdep      = right.fEdep;
+  fTime      = right.fTime;
+  fPrePos    = right.fPrePos;
+  fPostPos   = right.fPostPos;
+  fInteraction = right.fInteraction;
+  fWeight    = right.fWeight;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const DetectorHit& DetectorHit::operator=(const DetectorHit& right)
+{
+  fTrackID   = right.fTrackID;
+  fParentID  = right.fParentID;
+  fParticle  = right.fParticle;
+  fEnergy    = right.fEnergy;
+  fEdep      = right.fEdep;
+  fTime      = right.fTime;
+  fPrePos    = right.fPrePos;
+  fPostPos   = right.fPostPos;
+  fInteraction = right.fInteraction;
+  fWeight    = right.fWeight;
+
+  return *this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorHit::operator==(const DetectorHit& right) const
+{
+  return ( this == &right ) ? true : false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorHit::Draw()
+{
+  G4VVisManager* pVVisManager = G4VVisManager::GetConcreteInstance();
+  if(pVVisManager)
+  {
+    G4Circle circle(fPostPos);
+    circle.SetScreenSize(4.);
+    circle.SetFillStyle(G4Circle::filled);
+    G4Colour colour(1.,0.,0.);
+    G4VisAttributes attribs(colour);
+    circle.SetVisAttributes(attribs);
+    pVVisManager->Draw(circle);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorHit::Print()
+{
+  G4cout
+     << "  trackID: " << fTrackID << " parentID: " << fParentID
+     << " " << (fParticle ? fParticle->GetParticleName() : "unknown")
+     << " Energy: "
+     << std::setw(7) << G4BestUnit(fEnergy,"Energy")
+     << " Edep: "
+     << std::setw(7) << G4BestUnit(fEdep,"Energy")
+     << " Position: "
+     << std::setw(7) << G4BestUnit( fPostPos,"Length")
+     << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,242 @@
+/// \file DetectorRegions.cc
+/// \brief Implementation of the DetectorRegions class
+
+#include "DetectorRegions.hh"
+#include "PhysicsTableCache.hh"
+
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4UserLimits.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "G4StateManager.hh"
+#include "G4UIcommand.hh"
+#include "G4UnitsTable.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <map>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // Root volumes of the regions. Volumes missing in the current geometry
+  // mode are skipped: the boolean setup has AirTee, the placed one the
+  // Container and the air bores inside the steel pipes.
+  const std::pair<const char*, const char*> kRootVolumes[] = {
+    { "Envelope",          "Tank" },
+    { "SteelGuidePipeTub", "Pipes" },
+    { "SteelBeamPipeTub",  "Pipes" },
+    { "AirTee",            "AirTee" },
+    { "Container",         "AirTee" },
+    { "AirGuidePipeTub",   "AirTee" },
+    { "AirBeamPipeTub",    "AirTee" },
+    { "Scintillator",      "Detector" },
+    { "DetectorTub",       "Detector" }
+  };
+
+  // Daughters share the limits of their mother, unless they are the root
+  // of a region themselves
+  void SetUserLimits(G4LogicalVolume* volume, G4UserLimits* limits,
+                     const std::map<G4LogicalVolume*, G4Region*>& roots)
+  {
+    volume->SetUserLimits(limits);
+    for (size_t i = 0; i < volume->GetNoDaughters(); ++i) {
+      G4LogicalVolume* daughter = volume->GetDaughter(i)->GetLogicalVolume();
+      if (roots.count(daughter) == 0) SetUserLimits(daughter, limits, roots);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorRegions::DetectorRegions(G4VModularPhysicsList* physicsList)
+ : fMessenger(0),
+   fPhysicsList(physicsList),
+   fRegistered(false)
+{
+  // The regions outlive the geometry: a rebuild only attaches the new
+  // volumes. Until a cut is set they share the global production cuts,
+  // and their user limits do not limit anything.
+  auto defaultCuts
+    = G4ProductionCutsTable::GetProductionCutsTable()
+        ->GetDefaultProductionCuts();
+  for (const auto& name : Names()) {
+    G4Region* region = G4RegionStore::GetInstance()->FindOrCreateRegion(name);
+    region->SetProductionCuts(defaultCuts);
+    region->SetUserLimits(new G4UserLimits());
+  }
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorRegions::~DetectorRegions()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4String>& DetectorRegions::Names()
+{
+  static const std::vector<G4String> names
+    = { "Tank", "Pipes", "AirTee", "Detector" };
+  return names;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::AssignVolumes()
+{
+  auto volumeStore = G4LogicalVolumeStore::GetInstance();
+  auto regionStore = G4RegionStore::GetInstance();
+  std::map<G4LogicalVolume*, G4Region*> roots;
+  for (const auto& root : kRootVolumes) {
+    G4LogicalVolume* volume = volumeStore->GetVolume(root.first, false);
+    if (!volume) continue;
+    G4Region* region = regionStore->FindOrCreateRegion(root.second);
+    region->AddRootLogicalVolume(volume);
+    roots[volume] = region;
+  }
+  // Geant4 propagates the region to the daughters at the start of the
+  // run, the user limits are set here; the commands change them in place
+  for (const auto& root : roots) {
+    SetUserLimits(root.first, root.second->GetUserLimits(), roots);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorRegions::ReadValue(const G4String& definition,
+                                  const G4String& category,
+                                  G4String& region, G4double& value) const
+{
+  std::istringstream in(definition);
+  G4String unit;
+  in >> region >> value >> unit;
+  const auto& names = Names();
+  if (in && value >= 0. && G4UIcommand::CategoryOf(unit) == category
+      && std::find(names.begin(), names.end(), region) != names.end()) {
+    value *= G4UIcommand::ValueOf(unit);
+    return true;
+  }
+  G4ExceptionDescription msg;
+  msg << "Invalid region setting \"" << definition << "\", expected"
+      << " region value unit (" << category << "); regions:";
+  for (const auto& name : names) msg << " " << name;
+  G4Exception("DetectorRegions::ReadValue()", "toyMC001", JustWarning, msg);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::SetCut(const G4String& definition)
+{
+  G4String name;
+  G4double cut;
+  if (!ReadValue(definition, "Length", name, cut)) return;
+
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion(name);
+  G4ProductionCuts* cuts = region->GetProductionCuts();
+  if (cuts == G4ProductionCutsTable::GetProductionCutsTable()
+                ->GetDefaultProductionCuts()) {
+    cuts = new G4ProductionCuts(*cuts);
+    region->SetProductionCuts(cuts);
+  }
+  // Geant4 rebuilds the tables of the changed couples at the next run
+  cuts->SetProductionCut(cut);
+  PhysicsTableCache::Cancel("region " + name + " has its own cuts");
+  G4cout << "Region " << name << ": production cut "
+         << G4BestUnit(cut, "Length") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::SetMaxStep(const G4String& definition)
+{
+  G4String name;
+  G4double step;
+  if (!ReadValue(definition, "Length", name, step)) return;
+  RegisterStepLimiter();
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion(name);
+  region->GetUserLimits()->SetMaxAllowedStep(step > 0. ? step : DBL_MAX);
+  G4cout << "Region " << name << ": maximum step "
+         << G4BestUnit(step, "Length") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::SetMinEkin(const G4String& definition)
+{
+  G4String name;
+  G4double energy;
+  if (!ReadValue(definition, "Energy", name, energy)) return;
+  RegisterStepLimiter();
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion(name);
+  region->GetUserLimits()->SetUserMinEkine(energy);
+  G4cout << "Region " << name << ": charged particles killed below "
+         << G4BestUnit(energy, "Energy") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::RegisterStepLimiter()
+{
+  // The limits are only looked at by the step limiter processes, which
+  // are added when first needed, as they cost time in every step
+  if (fRegistered) return;
+  if (G4StateManager::GetStateManager()->GetCurrentState()
+        != G4State_PreInit) {
+    G4Exception("DetectorRegions::RegisterStepLimiter()", "toyMC001",
+                JustWarning, "The step limiter physics can only be added"
+                " before /run/initialize, the user limits have no effect.");
+    return;
+  }
+  fPhysicsList->RegisterPhysics(new G4StepLimiterPhysics());
+  fRegistered = true;
+  PhysicsTableCache::Cancel("the step limiter physics adds processes");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegions::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/region/",
+                             "Production cuts and user limits per region");
+
+  // The regions and the physics list are shared by all threads
+  auto& cutCmd
+    = fMessenger->DeclareMethod("cut", &DetectorRegions::SetCut,
+        "Production cut of gammas, e-, e+ and protons in a region:"
+        " region value unit (regions Tank, Pipes, AirTee, Detector).");
+  cutCmd.SetParameterName("definition", false);
+  cutCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  cutCmd.SetToBeBroadcasted(false);
+
+  auto& stepCmd
+    = fMessenger->DeclareMethod("maxStep", &DetectorRegions::SetMaxStep,
+        "Maximum step of charged particles in a region: region value unit"
+        " (0 for none). The first use must precede /run/initialize.");
+  stepCmd.SetParameterName("definition", false);
+  stepCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  stepCmd.SetToBeBroadcasted(false);
+
+  auto& ekinCmd
+    = fMessenger->DeclareMethod("minEkin", &DetectorRegions::SetMinEkin,
+        "Kill charged particles below this kinetic energy in a region:"
+        " region value unit. The first use must precede /run/initialize.");
+  ekinCmd.SetParameterName("definition", false);
+  ekinCmd.AvailableForStates(G4State_PreInit, G4State_Idle);
+  ekinCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,64 @@
+/// \file DetectorSD.cc
+/// \brief Implementation of the DetectorSD class
+
+#include "DetectorSD.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4SDManager.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorSD::DetectorSD(const G4String& name,
+                       const G4String& hitsCollectionName)
+ : G4VSensitiveDetector(name),
+   fHitsCollection(0)
+{
+  collectionName.insert(hitsCollectionName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorSD::~DetectorSD()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorSD::Initialize(G4HCofThisEvent* hce)
+{
+  // Create hits collection
+  fHitsCollection
+    = new DetectorHitsCollection(SensitiveDetectorName, collectionName[0]);
+
+  // Add this collection in hce
+  G4int hcID
+    = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
+  hce->AddHitsCollection( hcID, fHitsCollection );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  const G4Track* track = step->GetTrack();
+  const G4StepPoint* preStepPoint = step->GetPreStepPoint();
+
+  auto newHit = new DetectorHit();
+  newHit->SetTrackID(track->GetTrackID());
+  newHit->SetParentID(track->GetParentID());
+  newHit->SetParticle(track->GetDefinition());
+  newHit->SetEnergy(preStepPoint->GetKineticEnergy());
+  newHit->SetEdep(step->GetTotalEnergyDeposit());
+  newHit->SetTime(preStepPoint->GetGlobalTime());
+  newHit->SetPrePos(preStepPoint->GetPosition());
+  newHit->SetPostPos(step->GetPostStepPoint()->GetPosition());
+  newHit->SetWeight(track->GetWeight());
+  newHit->SetInteraction(
+    step->GetPostStepPoint()->GetStepStatus() == fPostStepDoItProc);
+
+  fHitsCollection->insert( newHit );
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
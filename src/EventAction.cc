@@ -3,13 +3,29 @@
 
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "DetectorHit.hh"
+#include "StartupTimer.hh"
+#include "NtupleWriter.hh"
+#include "EventTrigger.hh"
+#include "ProgressMonitor.hh"
+#include "EventHistograms.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4RunManager.hh"
+#include "G4SDManager.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4ParticleDefinition.hh"
+
+#include <algorithm>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 EventAction::EventAction(RunAction* runAction)
+: fRunAction(runAction),
+  fDetectorHCID(-1),
+  fScintillatorHCID(-1),
+  fFirstEventDone(false)
 {} 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -19,18 +35,184 @@ EventAction::~EventAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::BeginOfEventAction(const G4Event* pEvent)
-{    
-  if (pEvent->GetEventID() % 1000 == 0) {
-    G4cout << "------ Begin event " << pEvent->GetEventID() << " ------"
-           << G4endl;
+void EventAction::EndOfEventAction(const G4Event* event)
+{   
+  if (!fFirstEventDone) {
+    StartupTimer::Mark("first event");
+    fFirstEventDone = true;
+  }
+  fRunAction->GetProgress()->EndOfEvent(fRunAction->GetNofSteps());
+
+  // Collection IDs are known once the sensitive detectors are registered
+  if (fDetectorHCID < 0) {
+    fDetectorHCID = G4SDManager::GetSDMpointer()
+                      ->GetCollectionID("DetectorSD/DetectorHitsCollection");
+    fScintillatorHCID = G4SDManager::GetSDMpointer()
+      ->GetCollectionID("ScintillatorSD/ScintillatorHitsCollection");
+  }
+
+  // Events without a primary (a biased DD direction outside the table)
+  // have nothing to record
+  auto hce = event->GetHCofThisEvent();
+  if (!hce || event->GetNumberOfPrimaryVertex() == 0) return;
+  auto detectorHC
+    = static_cast<DetectorHitsCollection*>(hce->GetHC(fDetectorHCID));
+  auto scintillatorHC
+    = static_cast<DetectorHitsCollection*>(hce->GetHC(fScintillatorHCID));
+  EventTrigger* trigger = fRunAction->GetTrigger();
+  if (trigger->IsActive()
+      && !trigger->Accept(scintillatorHC, detectorHC)) return;
+
+  // Histograms of the accepted events, also without DetectorTub hits
+  EventHistograms* histograms = fRunAction->GetHistograms();
+  if (histograms->IsActive()) {
+    histograms->Fill(scintillatorHC, detectorHC,
+                     event->GetPrimaryVertex()->GetPosition(),
+                     fRunAction->GetWriter());
+  }
+  if (!detectorHC || detectorHC->entries() == 0) return;
+
+  // Event number within the shard, also over checkpointed segments
+  G4int eventID = fRunAction->GetEventOffset() + event->GetEventID();
+  switch (fRunAction->GetOutputMode()) {
+    case OutputMode::Step:  FillSteps(detectorHC, eventID);  break;
+    case OutputMode::Track: FillTracks(detectorHC, eventID); break;
+    case OutputMode::Event: FillEvent(detectorHC, eventID);  break;
+    case OutputMode::None:  break;
   }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event*)
-{   
+void EventAction::FillSteps(const DetectorHitsCollection* hc, G4int eventID)
+{
+  // One row per step inside DetectorTub; energies in keV
+  NtupleWriter* writer = fRunAction->GetWriter();
+  G4int shard = fRunAction->GetShard();
+  for (size_t i = 0; i < hc->entries(); ++i) {
+    DetectorHit* hit = (*hc)[i];
+    G4ThreeVector pre = hit->GetPrePos();
+    G4ThreeVector post = hit->GetPostPos();
+    writer->FillNtupleFColumn(0, 1000*hit->GetEnergy());
+    writer->FillNtupleFColumn(1, pre.x());
+    writer->FillNtupleFColumn(2, pre.y());
+    writer->FillNtupleFColumn(3, pre.z());
+    writer->FillNtupleFColumn(4, post.x());
+    writer->FillNtupleFColumn(5, post.y());
+    writer->FillNtupleFColumn(6, post.z());
+    writer->FillNtupleIColumn(7, hit->GetParticle()->GetPDGEncoding());
+    writer->FillNtupleIColumn(8, eventID);
+    writer->FillNtupleIColumn(9, hit->GetTrackID());
+    writer->FillNtupleIColumn(10, hit->GetParentID());
+    writer->FillNtupleFColumn(11, 1000*hit->GetEdep());
+    writer->FillNtupleIColumn(12, shard);
+    writer->FillNtupleFColumn(13, hit->GetWeight());
+    writer->AddNtupleRow();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::FillTracks(const DetectorHitsCollection* hc, G4int eventID)
+{
+  // A track is transported to its end before the next one is started, so
+  // the hits of one track are contiguous in the collection. A track which
+  // leaves and re-enters DetectorTub gives a single row; a track whose
+  // weight changes (forced collision) gives one row per weight, as the
+  // events in FillEvent.
+  NtupleWriter* writer = fRunAction->GetWriter();
+  G4int shard = fRunAction->GetShard();
+  size_t first = 0;
+  while (first < hc->entries()) {
+    DetectorHit* entry = (*hc)[first];
+    size_t last = first;
+    G4double edep = entry->GetEdep();
+    G4int nScatter = entry->IsInteraction() ? 1 : 0;
+    while (last+1 < hc->entries()
+           && (*hc)[last+1]->GetTrackID() == entry->GetTrackID()
+           && (*hc)[last+1]->GetWeight() == entry->GetWeight()) {
+      ++last;
+      edep += (*hc)[last]->GetEdep();
+      if ((*hc)[last]->IsInteraction()) ++nScatter;
+    }
+    G4ThreeVector in = entry->GetPrePos();
+    G4ThreeVector out = (*hc)[last]->GetPostPos();
+    writer->FillNtupleFColumn(0, 1000*entry->GetEnergy());
+    writer->FillNtupleFColumn(1, in.x());
+    writer->FillNtupleFColumn(2, in.y());
+    writer->FillNtupleFColumn(3, in.z());
+    writer->FillNtupleFColumn(4, out.x());
+    writer->FillNtupleFColumn(5, out.y());
+    writer->FillNtupleFColumn(6, out.z());
+    writer->FillNtupleFColumn(7, 1000*edep);
+    writer->FillNtupleIColumn(8, nScatter);
+    writer->FillNtupleIColumn(9, last - first + 1);
+    writer->FillNtupleIColumn(10, eventID);
+    writer->FillNtupleIColumn(11, shard);
+    writer->FillNtupleIColumn(12, entry->GetParticle()->GetPDGEncoding());
+    writer->FillNtupleIColumn(13, entry->GetTrackID());
+    writer->FillNtupleIColumn(14, entry->GetParentID());
+    writer->FillNtupleFColumn(15, entry->GetWeight());
+    writer->AddNtupleRow();
+    first = last + 1;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::FillEvent(const DetectorHitsCollection* hc, G4int eventID)
+{
+  // One row per weight: with forced collision the biased and unbiased
+  // histories of an event carry different weights, and their deposits are
+  // not added. Without biasing this is one row for the event.
+  fWeights.clear();
+  for (size_t i = 0; i < hc->entries(); ++i) {
+    G4double weight = (*hc)[i]->GetWeight();
+    if (std::find(fWeights.begin(), fWeights.end(), weight) == fWeights.end()) {
+      fWeights.push_back(weight);
+    }
+  }
+  NtupleWriter* writer = fRunAction->GetWriter();
+  for (G4double weight : fWeights) {
+    // Entry is the earliest step in DetectorTub, exit the latest one
+    DetectorHit* entry = nullptr;
+    DetectorHit* exit = nullptr;
+    G4double edep = 0.;
+    G4int nScatter = 0;
+    G4int nStep = 0;
+    G4int nTrack = 0;
+    G4int lastTrackID = -1;
+    for (size_t i = 0; i < hc->entries(); ++i) {
+      DetectorHit* hit = (*hc)[i];
+      if (hit->GetWeight() != weight) continue;
+      if (!entry || hit->GetTime() < entry->GetTime()) entry = hit;
+      if (!exit || hit->GetTime() >= exit->GetTime()) exit = hit;
+      edep += hit->GetEdep();
+      ++nStep;
+      if (hit->IsInteraction()) ++nScatter;
+      if (hit->GetTrackID() != lastTrackID) {
+        ++nTrack;
+        lastTrackID = hit->GetTrackID();
+      }
+    }
+    G4ThreeVector in = entry->GetPrePos();
+    G4ThreeVector out = exit->GetPostPos();
+    writer->FillNtupleFColumn(0, 1000*entry->GetEnergy());
+    writer->FillNtupleFColumn(1, in.x());
+    writer->FillNtupleFColumn(2, in.y());
+    writer->FillNtupleFColumn(3, in.z());
+    writer->FillNtupleFColumn(4, out.x());
+    writer->FillNtupleFColumn(5, out.y());
+    writer->FillNtupleFColumn(6, out.z());
+    writer->FillNtupleFColumn(7, 1000*edep);
+    writer->FillNtupleIColumn(8, nScatter);
+    writer->FillNtupleIColumn(9, nStep);
+    writer->FillNtupleIColumn(10, eventID);
+    writer->FillNtupleIColumn(11, fRunAction->GetShard());
+    writer->FillNtupleIColumn(12, nTrack);
+    writer->FillNtupleFColumn(13, weight);
+    writer->AddNtupleRow();
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,231 @@
+/// \file EventHistograms.cc
+/// \brief Implementation of the EventHistograms class
+
+#include "EventHistograms.hh"
+#include "NtupleWriter.hh"
+
+#include "G4Neutron.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UIcommand.hh"
+#include "g4root.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char* kQuantityNames[EventHistograms::kNofQuantities] = {
+    "neutronEnergy", "detectorEdep", "scintillatorEdep", "scatterAngle", "tof"
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventHistograms::EventHistograms()
+ : fMessenger(0),
+   fNofGroups(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventHistograms::~EventHistograms()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EventHistograms::ReadAxis(std::istream& in, Axis& axis) const
+{
+  G4String name;
+  in >> name >> axis.nBins >> axis.min >> axis.max >> axis.unit;
+  if (!in || axis.nBins < 1 || axis.max <= axis.min) return false;
+  for (G4int i = 0; i < kNofQuantities; ++i) {
+    if (name == kQuantityNames[i]) {
+      axis.quantity = static_cast<Quantity>(i);
+      // Edges in Geant4 units, as G4AnalysisManager expects them
+      G4double unit = G4UIcommand::ValueOf(axis.unit);
+      if (unit <= 0.) return false;
+      axis.min *= unit;
+      axis.max *= unit;
+      return true;
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventHistograms::BookH1(const G4String& definition)
+{
+  std::istringstream in(definition);
+  Histogram histogram;
+  if (!ReadAxis(in, histogram.x)) {
+    G4ExceptionDescription msg;
+    msg << "Invalid histogram \"" << definition << "\", expected"
+        << " quantity nbins min max unit; quantities:";
+    for (auto name : kQuantityNames) msg << " " << name;
+    G4Exception("EventHistograms::BookH1()", "toyMC001", JustWarning, msg);
+    return;
+  }
+  const Axis& x = histogram.x;
+  G4String name = kQuantityNames[x.quantity];
+  histogram.id
+    = G4AnalysisManager::Instance()->CreateH1(name, name + " [" + x.unit + "]",
+                                              x.nBins, x.min, x.max, x.unit);
+  fH1.push_back(histogram);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventHistograms::BookH2(const G4String& definition)
+{
+  std::istringstream in(definition);
+  Histogram histogram;
+  if (!ReadAxis(in, histogram.x) || !ReadAxis(in, histogram.y)) {
+    G4ExceptionDescription msg;
+    msg << "Invalid histogram \"" << definition << "\", expected"
+        << " quantity nbins min max unit for x and for y; quantities:";
+    for (auto name : kQuantityNames) msg << " " << name;
+    G4Exception("EventHistograms::BookH2()", "toyMC001", JustWarning, msg);
+    return;
+  }
+  const Axis& x = histogram.x;
+  const Axis& y = histogram.y;
+  G4String name = G4String(kQuantityNames[x.quantity]) + "_"
+                  + kQuantityNames[y.quantity];
+  G4String title = G4String(kQuantityNames[y.quantity]) + " [" + y.unit
+                   + "] vs " + kQuantityNames[x.quantity] + " [" + x.unit
+                   + "]";
+  histogram.id
+    = G4AnalysisManager::Instance()->CreateH2(name, title,
+                                              x.nBins, x.min, x.max,
+                                              y.nBins, y.min, y.max,
+                                              x.unit, y.unit);
+  fH2.push_back(histogram);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventHistograms::Fill(const DetectorHitsCollection* scintillator,
+                           const DetectorHitsCollection* detector,
+                           const G4ThreeVector& source,
+                           NtupleWriter* writer)
+{
+  fNofGroups = 0;
+
+  // Scintillator: deposit, first deposit, and the last interaction point
+  // of each neutron which interacted there
+  std::vector<std::pair<G4int, G4ThreeVector>> interactions;
+  size_t nScintillator = scintillator ? scintillator->entries() : 0;
+  for (size_t i = 0; i < nScintillator; ++i) {
+    const DetectorHit* hit = (*scintillator)[i];
+    Group& group = GroupOf(hit->GetWeight());
+    if (hit->GetEdep() > 0.) {
+      group.value[kScintillatorEdep] += hit->GetEdep();
+      group.scintillatorTime = std::min(group.scintillatorTime, hit->GetTime());
+    }
+    if (hit->IsInteraction() && hit->GetParticle() == G4Neutron::Definition()) {
+      // Hits of a track are contiguous, the last one wins
+      if (interactions.empty()
+          || interactions.back().first != hit->GetTrackID()) {
+        interactions.emplace_back(hit->GetTrackID(), hit->GetPostPos());
+      }
+      else {
+        interactions.back().second = hit->GetPostPos();
+      }
+    }
+  }
+
+  // DetectorTub: deposit, first hit, first neutron entering, and the entry
+  // point of the first neutron which interacted in the Scintillator
+  size_t nDetector = detector ? detector->entries() : 0;
+  for (size_t i = 0; i < nDetector; ++i) {
+    const DetectorHit* hit = (*detector)[i];
+    Group& group = GroupOf(hit->GetWeight());
+    group.value[kDetectorEdep] += hit->GetEdep();
+    group.detectorTime = std::min(group.detectorTime, hit->GetTime());
+    if (hit->GetParticle() != G4Neutron::Definition()) continue;
+    if (!group.defined[kNeutronEnergy]) {
+      group.value[kNeutronEnergy] = hit->GetEnergy();
+      group.defined[kNeutronEnergy] = true;
+    }
+    if (!group.defined[kScatterAngle]) {
+      for (const auto& interaction : interactions) {
+        if (interaction.first != hit->GetTrackID()) continue;
+        G4ThreeVector in = interaction.second - source;
+        G4ThreeVector out = hit->GetPrePos() - interaction.second;
+        group.value[kScatterAngle] = in.angle(out);
+        group.defined[kScatterAngle] = true;
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < fNofGroups; ++i) {
+    Group& group = fGroups[i];
+    group.defined[kScintillatorEdep] = group.value[kScintillatorEdep] > 0.;
+    group.defined[kDetectorEdep] = group.value[kDetectorEdep] > 0.;
+    if (group.detectorTime < DBL_MAX && group.scintillatorTime < DBL_MAX) {
+      group.value[kTof] = group.detectorTime - group.scintillatorTime;
+      group.defined[kTof] = true;
+    }
+    for (const auto& h : fH1) {
+      if (!group.defined[h.x.quantity]) continue;
+      writer->FillH1(h.id, group.value[h.x.quantity], group.weight);
+    }
+    for (const auto& h : fH2) {
+      if (!group.defined[h.x.quantity] || !group.defined[h.y.quantity]) {
+        continue;
+      }
+      writer->FillH2(h.id, group.value[h.x.quantity],
+                     group.value[h.y.quantity], group.weight);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventHistograms::Group& EventHistograms::GroupOf(G4double weight)
+{
+  // Few histories per event, the groups are kept between events
+  for (size_t i = 0; i < fNofGroups; ++i) {
+    if (fGroups[i].weight == weight) return fGroups[i];
+  }
+  if (fNofGroups == fGroups.size()) fGroups.emplace_back();
+  Group& group = fGroups[fNofGroups++];
+  group.weight = weight;
+  for (G4int i = 0; i < kNofQuantities; ++i) {
+    group.value[i] = 0.;
+    group.defined[i] = false;
+  }
+  group.scintillatorTime = DBL_MAX;
+  group.detectorTime = DBL_MAX;
+  return group;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventHistograms::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/histo/", "Event histograms");
+
+  auto& h1Cmd
+    = fMessenger->DeclareMethod("h1", &EventHistograms::BookH1,
+        "Book an H1 before the run: quantity nbins min max unit; quantities"
+        " neutronEnergy, detectorEdep, scintillatorEdep, scatterAngle, tof.");
+  h1Cmd.SetParameterName("definition", false);
+
+  auto& h2Cmd
+    = fMessenger->DeclareMethod("h2", &EventHistograms::BookH2,
+        "Book an H2 before the run: quantity nbins min max unit for x,"
+        " then for y.");
+  h2Cmd.SetParameterName("definition", false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
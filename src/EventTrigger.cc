@@ -0,0 +1,132 @@
+/// \file EventTrigger.cc
+/// \brief Implementation of the EventTrigger class
+
+#include "EventTrigger.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <set>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTrigger::EventTrigger()
+ : fMessenger(0),
+   fActive(false),
+   fThreshold(0.),
+   fTimeWindow(0.),
+   fSameTrack(false),
+   fNofTested(0.),
+   fNofAccepted(0.)
+{
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fNofTested);
+  accumulableManager->RegisterAccumulable(fNofAccepted);
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTrigger::~EventTrigger()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EventTrigger::Accept(const DetectorHitsCollection* scintillator,
+                            const DetectorHitsCollection* detector)
+{
+  fNofTested += 1.;
+  if (!scintillator || !detector || detector->entries() == 0) return false;
+
+  G4double edep = 0.;
+  G4double scintillatorTime = DBL_MAX;
+  std::set<G4int> scattered;
+  for (size_t i = 0; i < scintillator->entries(); ++i) {
+    const DetectorHit* hit = (*scintillator)[i];
+    if (hit->GetEdep() > 0.) {
+      edep += hit->GetEdep();
+      scintillatorTime = std::min(scintillatorTime, hit->GetTime());
+    }
+    if (fSameTrack && hit->IsInteraction()) scattered.insert(hit->GetTrackID());
+  }
+  if (edep <= fThreshold) return false;
+
+  G4double detectorTime = DBL_MAX;
+  G4bool reached = false;
+  for (size_t i = 0; i < detector->entries(); ++i) {
+    const DetectorHit* hit = (*detector)[i];
+    detectorTime = std::min(detectorTime, hit->GetTime());
+    if (!reached && scattered.count(hit->GetTrackID())) reached = true;
+  }
+  if (fSameTrack && !reached) return false;
+  if (fTimeWindow > 0.) {
+    G4double delay = detectorTime - scintillatorTime;
+    if (delay < 0. || delay > fTimeWindow) return false;
+  }
+
+  fNofAccepted += 1.;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTrigger::Print() const
+{
+  if (!fActive) return;
+
+  G4double nTested = fNofTested.GetValue();
+  G4double nAccepted = fNofAccepted.GetValue();
+  G4cout << G4endl << "--------------------Event trigger---------------------"
+         << G4endl
+         << " Scintillator deposit > " << G4BestUnit(fThreshold, "Energy")
+         << " and DetectorTub hit";
+  if (fSameTrack) G4cout << ", same track";
+  if (fTimeWindow > 0.) {
+    G4cout << ", within " << G4BestUnit(fTimeWindow, "Time");
+  }
+  G4cout << G4endl << " Accepted " << nAccepted << " of " << nTested
+         << " events (" << (nTested > 0. ? 100.*nAccepted/nTested : 0.)
+         << " %)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTrigger::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/trigger/", "Event trigger");
+
+  auto& enableCmd
+    = fMessenger->DeclareProperty("enable", fActive,
+        "Write only events with a Scintillator - DetectorTub coincidence.");
+  enableCmd.SetParameterName("enable", true);
+  enableCmd.SetDefaultValue("true");
+
+  auto& thresholdCmd
+    = fMessenger->DeclarePropertyWithUnit("threshold", "keV", fThreshold,
+        "Minimum energy deposited in the Scintillator.");
+  thresholdCmd.SetParameterName("energy", false);
+  thresholdCmd.SetRange("energy>=0.");
+
+  auto& windowCmd
+    = fMessenger->DeclarePropertyWithUnit("timeWindow", "ns", fTimeWindow,
+        "Maximum delay of the DetectorTub hit after the Scintillator"
+        " deposit (0 = off).");
+  windowCmd.SetParameterName("time", false);
+  windowCmd.SetRange("time>=0.");
+
+  auto& sameTrackCmd
+    = fMessenger->DeclareProperty("sameTrack", fSameTrack,
+        "Require a track which interacted in the Scintillator to reach"
+        " DetectorTub.");
+  sameTrackCmd.SetParameterName("sameTrack", true);
+  sameTrackCmd.SetDefaultValue("true");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,196 @@
+/// \file NtupleWriter.cc
+/// \brief Implementation of the NtupleWriter class
+
+#include "NtupleWriter.hh"
+
+#include "G4GenericMessenger.hh"
+#include "g4root.hh"
+
+#include <chrono>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // Rows handed to the analysis manager before the slots are released
+  const size_t kBatchSize = 256;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NtupleWriter::NtupleWriter()
+ : fMessenger(0),
+   fAnalysisManager(G4AnalysisManager::Instance()),
+   fAsync(true),
+   fBufferSize(65536),
+   fMask(0),
+   fHead(0),
+   fTail(0),
+   fStop(false),
+   fNofStalls(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NtupleWriter::~NtupleWriter()
+{
+  Flush();
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::AddNtupleRow()
+{
+  Push(fRow);
+  fRow.filledMask = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::FillH1(G4int id, G4double x, G4double weight)
+{
+  Row fill;
+  fill.h1 = id;
+  fill.x = x;
+  fill.weight = weight;
+  Push(fill);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::FillH2(G4int id, G4double x, G4double y, G4double weight)
+{
+  Row fill;
+  fill.h2 = id;
+  fill.x = x;
+  fill.y = y;
+  fill.weight = weight;
+  Push(fill);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::Push(const Row& row)
+{
+  if (!fAsync) {
+    Write(row);
+    return;
+  }
+  if (!fThread.joinable()) Start();
+
+  size_t head = fHead.load(std::memory_order_relaxed);
+  if (head - fTail.load(std::memory_order_acquire) > fMask) {
+    ++fNofStalls;
+    while (head - fTail.load(std::memory_order_acquire) > fMask) {
+      std::this_thread::yield();
+    }
+  }
+  fBuffer[head & fMask] = row;
+  fHead.store(head + 1, std::memory_order_release);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::Start()
+{
+  // Round the buffer up to a power of two, for the index mask
+  size_t size = 1;
+  while (size < (size_t) fBufferSize) size <<= 1;
+  if (fBuffer.size() != size) fBuffer.assign(size, Row());
+  fMask = size - 1;
+  fHead.store(0);
+  fTail.store(0);
+  fStop.store(false);
+  fNofStalls = 0;
+  fThread = std::thread(&NtupleWriter::Run, this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::Flush()
+{
+  if (!fThread.joinable()) return;
+  fStop.store(true, std::memory_order_release);
+  fThread.join();
+  if (fNofStalls > 0) {
+    G4cout << "NtupleWriter: the event loop waited " << fNofStalls
+           << " times for a full output buffer of " << fBuffer.size()
+           << " rows (/toy/output/bufferSize)" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::Run()
+{
+  while (true) {
+    // Read the stop flag first: if it is set and the buffer is then found
+    // empty, every row pushed before the flush has been written
+    G4bool stop = fStop.load(std::memory_order_acquire);
+    if (Drain() > 0) continue;
+    if (stop) break;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+size_t NtupleWriter::Drain()
+{
+  size_t tail = fTail.load(std::memory_order_relaxed);
+  size_t head = fHead.load(std::memory_order_acquire);
+  if (head - tail > kBatchSize) head = tail + kBatchSize;
+  for (size_t i = tail; i < head; ++i) Write(fBuffer[i & fMask]);
+  fTail.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::Write(const Row& row)
+{
+  // Not G4AnalysisManager::Instance(): the instances are per thread, the
+  // rows go to the one of the event loop
+  if (row.h1 >= 0) {
+    fAnalysisManager->FillH1(row.h1, row.x, row.weight);
+    return;
+  }
+  if (row.h2 >= 0) {
+    fAnalysisManager->FillH2(row.h2, row.x, row.y, row.weight);
+    return;
+  }
+  for (G4int column = 0; column < kMaxColumns; ++column) {
+    if (!(row.filledMask & (1u << column))) continue;
+    if (row.floatMask & (1u << column)) {
+      fAnalysisManager->FillNtupleFColumn(column, row.cells[column].f);
+    }
+    else {
+      fAnalysisManager->FillNtupleIColumn(column, row.cells[column].i);
+    }
+  }
+  fAnalysisManager->AddNtupleRow();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NtupleWriter::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/output/", "Ntuple output");
+
+  auto& asyncCmd
+    = fMessenger->DeclareProperty("async", fAsync,
+        "Write the ntuple rows from a separate thread per event loop.");
+  asyncCmd.SetParameterName("async", true);
+  asyncCmd.SetDefaultValue("true");
+
+  auto& sizeCmd
+    = fMessenger->DeclareProperty("bufferSize", fBufferSize,
+        "Rows buffered per event loop thread in async mode.");
+  sizeCmd.SetParameterName("rows", false);
+  sizeCmd.SetRange("rows>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,215 @@
+/// \file PhaseSpaceRecorder.cc
+/// \brief Implementation of the PhaseSpaceRecorder class
+
+#include "PhaseSpaceRecorder.hh"
+
+#include "G4Step.hh"
+#include "G4VTouchable.hh"
+#include "G4Track.hh"
+#include "G4Run.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4EventManager.hh"
+#include "G4Event.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // The file shared by the threads of the process
+  std::mutex gFileMutex;
+  std::FILE* gFile = nullptr;
+  G4long gNofRecords = 0;
+
+  const size_t kBufferSize = 4096;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceRecorder::PhaseSpaceRecorder()
+ : fMessenger(0),
+   fFileName(""),
+   fKill(true),
+   fVolume(nullptr),
+   fResolved(true)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceRecorder::~PhaseSpaceRecorder()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::SetVolume(const G4String& name)
+{
+  fVolumeName = name;
+  fResolved = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceRecorder::Record(const G4Step* step)
+{
+  const G4StepPoint* post = step->GetPostStepPoint();
+  if (post->GetStepStatus() != fGeomBoundary) return false;
+
+  if (!fResolved) {
+    // Looked up when first needed, the command may come before the
+    // geometry is built
+    fVolume = G4LogicalVolumeStore::GetInstance()->GetVolume(fVolumeName,
+                                                             false);
+    if (!fVolume) {
+      G4ExceptionDescription msg;
+      msg << "Record volume " << fVolumeName << " not found, nothing is"
+          << " recorded.";
+      G4Exception("PhaseSpaceRecorder::Record()", "toyMC001", JustWarning,
+                  msg);
+    }
+    fResolved = true;
+  }
+  G4VPhysicalVolume* next = post->GetPhysicalVolume();
+  if (!fVolume || !next || next->GetLogicalVolume() != fVolume) return false;
+  // Coming back from a daughter is not entering: the step must start
+  // outside the volume, at any depth of the pre-step touchable
+  const G4VTouchable* touchable = step->GetPreStepPoint()->GetTouchable();
+  for (G4int depth = 0; depth <= touchable->GetHistoryDepth(); ++depth) {
+    if (touchable->GetVolume(depth)->GetLogicalVolume() == fVolume) {
+      return false;
+    }
+  }
+
+  const G4Track* track = step->GetTrack();
+  G4ThreeVector position = post->GetPosition();
+  G4ThreeVector direction = post->GetMomentumDirection();
+  PhaseSpaceRecord record;
+  record.pdg = track->GetDefinition()->GetPDGEncoding();
+  record.eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()
+                     ->GetEventID();
+  record.x = position.x()/mm;
+  record.y = position.y()/mm;
+  record.z = position.z()/mm;
+  record.dx = direction.x();
+  record.dy = direction.y();
+  record.dz = direction.z();
+  record.energy = post->GetKineticEnergy()/MeV;
+  record.time = post->GetGlobalTime()/ns;
+  record.weight = track->GetWeight();
+  fBuffer.push_back(record);
+  if (fBuffer.size() >= kBufferSize) Flush();
+  return fKill;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::Flush()
+{
+  if (fBuffer.empty()) return;
+  std::lock_guard<std::mutex> lock(gFileMutex);
+  if (gFile) {
+    std::fwrite(fBuffer.data(), sizeof(PhaseSpaceRecord), fBuffer.size(),
+                gFile);
+    gNofRecords += fBuffer.size();
+  }
+  fBuffer.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::BeginOfRun(G4bool isMaster,
+                                    const G4String& outputFile,
+                                    const G4String& suffix)
+{
+  // Look the volume up again, the geometry may have been rebuilt
+  fResolved = !IsActive();
+  if (!isMaster || !IsActive()) return;
+
+  // rec.phsp -> rec<suffix>.phsp; the output file has the suffix already,
+  // out/run<suffix>.root -> out/run<suffix>.phsp
+  G4bool derived = fFileName.empty();
+  G4String base = derived ? outputFile : fFileName;
+  const G4String extension = derived ? ".root" : ".phsp";
+  if (base.size() > extension.size()
+      && base.compare(base.size() - extension.size(), extension.size(),
+                      extension) == 0) {
+    base.erase(base.size() - extension.size());
+  }
+  fRunFileName = base + (derived ? "" : suffix) + ".phsp";
+  std::lock_guard<std::mutex> lock(gFileMutex);
+  gFile = std::fopen(fRunFileName.c_str(), "wb");
+  if (!gFile) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the phase-space file " << fRunFileName;
+    G4Exception("PhaseSpaceRecorder::BeginOfRun()", "toyMC003",
+                FatalException, msg);
+    return;
+  }
+  // Header completed at the end of the run
+  PhaseSpaceHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::fwrite(&header, sizeof(header), 1, gFile);
+  gNofRecords = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::EndOfRun(const G4Run* run, G4bool isMaster)
+{
+  Flush();
+  if (!isMaster || !IsActive()) return;
+
+  // The workers have ended their runs, and flushed, before the master
+  std::lock_guard<std::mutex> lock(gFileMutex);
+  if (!gFile) return;
+  PhaseSpaceHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, "TOYPHSP1", 8);
+  header.recordSize = sizeof(PhaseSpaceRecord);
+  header.nPrimaries = run->GetNumberOfEvent();
+  header.nRecords = gNofRecords;
+  std::fseek(gFile, 0, SEEK_SET);
+  std::fwrite(&header, sizeof(header), 1, gFile);
+  std::fclose(gFile);
+  gFile = nullptr;
+  G4cout << " Phase space: " << gNofRecords << " particles entering "
+         << fVolumeName << " in " << header.nPrimaries << " events written to "
+         << fRunFileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/record/",
+                             "Phase-space recording (stage one)");
+
+  auto& volumeCmd
+    = fMessenger->DeclareMethod("volume", &PhaseSpaceRecorder::SetVolume,
+        "Record the particles entering this logical volume.");
+  volumeCmd.SetParameterName("name", false);
+
+  auto& fileCmd
+    = fMessenger->DeclareProperty("file", fFileName,
+        "Phase-space file (default: the output file, .root -> .phsp);"
+        " the tag and segment suffixes of the output file are inserted.");
+  fileCmd.SetParameterName("file", false);
+
+  auto& killCmd
+    = fMessenger->DeclareProperty("kill", fKill,
+        "Kill the recorded particles (default true).");
+  killCmd.SetParameterName("kill", true);
+  killCmd.SetDefaultValue("true");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,180 @@
+/// \file PhaseSpaceSource.cc
+/// \brief Implementation of the PhaseSpaceSource class
+
+#include "PhaseSpaceSource.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // The file shared by the threads of the process
+  std::mutex gFileMutex;
+  std::FILE* gFile = nullptr;
+  G4String gFileName;
+  G4int gNofPasses = 0;
+
+  // Slice of the records replayed by this shard
+  G4int gShard = 0;
+  G4int gNofShards = 1;
+  long long gFirst = 0;
+  long long gEnd = 0;
+  long long gPosition = 0;
+
+  const size_t kChunkSize = 1024;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceSource::PhaseSpaceSource()
+ : fMessenger(0),
+   fRecycle(1),
+   fNext(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceSource::~PhaseSpaceSource()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceSource::SetShard(G4int shard, G4int nShards)
+{
+  gShard = shard;
+  gNofShards = nShards;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceSource::ReadChunk()
+{
+  std::lock_guard<std::mutex> lock(gFileMutex);
+  if (gFile && gFileName != fFileName) {
+    std::fclose(gFile);
+    gFile = nullptr;
+  }
+  if (!gFile) {
+    gFile = std::fopen(fFileName.c_str(), "rb");
+    PhaseSpaceHeader header;
+    if (!gFile
+        || std::fread(&header, sizeof(header), 1, gFile) != 1
+        || std::memcmp(header.magic, "TOYPHSP1", 8) != 0
+        || header.recordSize != sizeof(PhaseSpaceRecord)) {
+      G4ExceptionDescription msg;
+      msg << fFileName << " is not a phase-space file of this version.";
+      G4Exception("PhaseSpaceSource::ReadChunk()", "toyMC003",
+                  FatalException, msg);
+      return;
+    }
+    gFileName = fFileName;
+    gNofPasses = -1;
+    gFirst = header.nRecords*gShard/gNofShards;
+    gEnd = header.nRecords*(gShard + 1)/gNofShards;
+    if (gEnd <= gFirst) {
+      G4ExceptionDescription msg;
+      msg << fFileName << " has " << header.nRecords << " records, too few"
+          << " for " << gNofShards << " shards.";
+      G4Exception("PhaseSpaceSource::ReadChunk()", "toyMC003",
+                  FatalException, msg);
+      return;
+    }
+    gPosition = gEnd;
+    G4cout << "Replaying particles " << gFirst << " to " << gEnd - 1
+           << " of " << header.nRecords << " (" << header.nPrimaries
+           << " primaries) from " << fFileName << G4endl;
+  }
+
+  if (gPosition >= gEnd) {
+    // First chunk, or end of the slice: start over at its first record
+    std::fseek(gFile, sizeof(PhaseSpaceHeader)
+                        + gFirst*sizeof(PhaseSpaceRecord), SEEK_SET);
+    gPosition = gFirst;
+    if (++gNofPasses > 0) {
+      G4ExceptionDescription msg;
+      msg << fFileName << " exhausted, replayed again (pass "
+          << gNofPasses + 1 << "); divide the tallies by the number of"
+          << " passes.";
+      G4Exception("PhaseSpaceSource::ReadChunk()", "toyMC001", JustWarning,
+                  msg);
+    }
+  }
+
+  size_t n = std::min<long long>(kChunkSize, gEnd - gPosition);
+  fChunk.resize(n);
+  n = std::fread(fChunk.data(), sizeof(PhaseSpaceRecord), n, gFile);
+  if (n == 0) {
+    G4Exception("PhaseSpaceSource::ReadChunk()", "toyMC003",
+                FatalException, (fFileName + " is truncated.").c_str());
+  }
+  fChunk.resize(n);
+  gPosition += n;
+  fNext = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceSource::GeneratePrimaries(G4Event* event)
+{
+  if (fNext >= fChunk.size()) ReadChunk();
+  const PhaseSpaceRecord& record = fChunk[fNext++];
+
+  auto particle
+    = G4ParticleTable::GetParticleTable()->FindParticle(record.pdg);
+  if (!particle) {
+    G4ExceptionDescription msg;
+    msg << "Unknown PDG code " << record.pdg << " in " << fFileName
+        << ", record skipped.";
+    G4Exception("PhaseSpaceSource::GeneratePrimaries()", "toyMC001",
+                JustWarning, msg);
+    return;
+  }
+  G4ThreeVector direction(record.dx, record.dy, record.dz);
+  for (G4int i = 0; i < fRecycle; ++i) {
+    auto vertex = new G4PrimaryVertex(record.x*mm, record.y*mm, record.z*mm,
+                                      record.time*ns);
+    auto primary = new G4PrimaryParticle(particle);
+    primary->SetKineticEnergy(record.energy*MeV);
+    primary->SetMomentumDirection(direction);
+    vertex->SetPrimary(primary);
+    vertex->SetWeight(record.weight/fRecycle);
+    event->AddPrimaryVertex(vertex);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceSource::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/replay/",
+                             "Phase-space replay (stage two)");
+
+  auto& fileCmd
+    = fMessenger->DeclareProperty("file", fFileName,
+        "Replay this phase-space file instead of the GPS.");
+  fileCmd.SetParameterName("file", false);
+
+  auto& recycleCmd
+    = fMessenger->DeclareProperty("recycle", fRecycle,
+        "Copies of each recorded particle, at 1/recycle of its weight.");
+  recycleCmd.SetParameterName("n", false);
+  recycleCmd.SetRange("n>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
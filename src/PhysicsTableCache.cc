@@ -0,0 +1,112 @@
+/// \file PhysicsTableCache.cc
+/// \brief Implementation of the PhysicsTableCache class
+
+#include "PhysicsTableCache.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4Version.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  G4VUserPhysicsList* gPhysicsList = nullptr;
+  G4bool gRetrieved = false;
+
+  G4String StampFile(const G4String& dir)
+  {
+    return dir + "/toyMC.stamp";
+  }
+
+  // One "key value" line per dependency of the stored tables
+  G4String Stamp(const G4String& listName)
+  {
+    const char* emData = std::getenv("G4LEDATA");
+    std::ostringstream stamp;
+    stamp << "geant4 " << G4Version << "\n"
+          << "physicsList " << listName << "\n"
+          << "G4LEDATA " << (emData ? emData : "") << "\n";
+    return stamp.str();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::Retrieve(G4VUserPhysicsList* physicsList,
+                                   const G4String& listName,
+                                   const G4String& dir)
+{
+  std::ifstream in(StampFile(dir));
+  std::stringstream stored;
+  stored << in.rdbuf();
+  G4String expected = Stamp(listName);
+  if (!in || stored.str() != expected) {
+    G4ExceptionDescription msg;
+    msg << "Physics tables in " << dir << " are missing or stale, they are"
+        << " built. Expected stamp:" << G4endl << expected
+        << "Run toyMC_batch --store-physics-tables " << dir << " to update.";
+    G4Exception("PhysicsTableCache::Retrieve()", "toyMC001", JustWarning,
+                msg);
+    return false;
+  }
+  physicsList->SetPhysicsTableRetrieved(dir);
+  gPhysicsList = physicsList;
+  gRetrieved = true;
+  G4cout << "Physics tables are retrieved from " << dir << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::Store(G4VUserPhysicsList* physicsList,
+                                const G4String& listName,
+                                const G4String& dir)
+{
+  // The stamp goes last, so that an interrupted store leaves the
+  // directory stale rather than half valid
+  mkdir(dir.c_str(), 0755);
+  std::remove(StampFile(dir).c_str());
+  if (!physicsList->StorePhysicsTable(dir)) {
+    G4ExceptionDescription msg;
+    msg << "Cannot store the physics tables in " << dir;
+    G4Exception("PhysicsTableCache::Store()", "toyMC003", FatalException,
+                msg);
+    return false;
+  }
+  std::ofstream out(StampFile(dir));
+  out << Stamp(listName);
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write " << StampFile(dir);
+    G4Exception("PhysicsTableCache::Store()", "toyMC003", FatalException,
+                msg);
+    return false;
+  }
+  G4cout << "Physics tables stored in " << dir << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsTableCache::Cancel(const G4String& reason)
+{
+  if (!gRetrieved) return;
+  gPhysicsList->ResetPhysicsTableRetrieved();
+  gRetrieved = false;
+  G4cout << "Physics tables are built, not retrieved: " << reason << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::IsRetrieved()
+{
+  // Geant4 builds the tables itself if the materials or cuts differ
+  return gRetrieved && gPhysicsList->IsPhysicsTableRetrieved();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -28,6 +28,8 @@
 /// \brief Implementation of the PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "PhaseSpaceSource.hh"
+#include "DDNeutronSource.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
@@ -36,14 +38,27 @@
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
+#include "G4Neutron.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4GeneralParticleSource.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PhysicalConstants.hh"
 #include "Randomize.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
-: G4VUserPrimaryGeneratorAction()
+: G4VUserPrimaryGeneratorAction(),
+  fMessenger(0),
+  fReplay(new PhaseSpaceSource),
+  fDDSource(new DDNeutronSource),
+  fBias(false),
+  fBiasTarget(0., 0., -5.*cm),
+  fBiasConeAngle(10.*deg),
+  fBiasFraction(0.9)
 {
   /*G4int n_particle = 1;
   fParticleGun  = new G4ParticleGun(n_particle);
@@ -57,6 +72,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0.,0.,1.));
   fParticleGun->SetParticleEnergy(6.*MeV);*/
   fParticleGun  = new G4GeneralParticleSource();
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -64,13 +80,148 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
   delete fParticleGun;
+  delete fMessenger;
+  delete fReplay;
+  delete fDDSource;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
+  if (fReplay->IsActive()) {
+    fReplay->GeneratePrimaries(anEvent);
+    return;
+  }
+  if (fDDSource->IsActive()) {
+    GenerateDD(anEvent);
+    return;
+  }
   fParticleGun->GeneratePrimaryVertex(anEvent);
+  if (fBias) {
+    G4PrimaryVertex* vertex = anEvent->GetPrimaryVertex();
+    vertex->SetWeight(vertex->GetWeight()*BiasDirection(vertex));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::GenerateDD(G4Event* event)
+{
+  // Direction first, from the DD angular distribution or biased, then the
+  // energy for its angle to the beam
+  G4ThreeVector position = fDDSource->GetPosition();
+  G4ThreeVector direction;
+  size_t angleBin;
+  G4double weight = 1.;
+  if (fBias) {
+    G4double density;
+    direction = SampleBiasedDirection(position, density);
+    angleBin = fDDSource->FindBin(direction);
+    weight = fDDSource->AngularDensity(angleBin)/density;
+    // Outside the angles of the table: the event counts as a primary
+    // with no neutron, as the source emits none there
+    if (weight <= 0.) return;
+  }
+  else {
+    direction = fDDSource->SampleDirection(angleBin);
+  }
+
+  auto vertex = new G4PrimaryVertex(position, 0.);
+  auto primary = new G4PrimaryParticle(G4Neutron::Definition());
+  primary->SetKineticEnergy(fDDSource->SampleEnergy(angleBin));
+  primary->SetMomentumDirection(direction);
+  vertex->SetPrimary(primary);
+  vertex->SetWeight(weight);
+  event->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::BiasDirection(G4PrimaryVertex* vertex)
+{
+  // The weight is the isotropic density over the biased one, so the GPS
+  // source of the event has to be isotropic
+  G4String angularDistribution
+    = fParticleGun->GetCurrentSource()->GetAngDist()->GetDistType();
+  if (angularDistribution != "iso") {
+    G4ExceptionDescription msg;
+    msg << "/toy/source/bias needs the isotropic GPS direction"
+        << " (/gps/ang/type iso), not " << angularDistribution << ".";
+    G4Exception("PrimaryGeneratorAction::BiasDirection()", "toyMC003",
+                FatalException, msg);
+    return 1.;
+  }
+  G4double density;
+  G4ThreeVector direction
+    = SampleBiasedDirection(vertex->GetPosition(), density);
+  for (G4int i = 0; i < vertex->GetNumberOfParticle(); ++i) {
+    vertex->GetPrimary(i)->SetMomentumDirection(direction);
+  }
+  return 1./(4.*pi)/density;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector
+PrimaryGeneratorAction::SampleBiasedDirection(const G4ThreeVector& position,
+                                              G4double& density) const
+{
+  // Mixture of a uniform cone around the target direction and the
+  // isotropic distribution; the isotropic part keeps every direction
+  // possible, with a weight of at most 1/(1-fBiasFraction) for an
+  // isotropic source
+  G4ThreeVector axis = (fBiasTarget - position).unit();
+  G4double cosCone = std::cos(fBiasConeAngle);
+  G4double cosTheta;
+  G4ThreeVector direction;
+  if (G4UniformRand() < fBiasFraction) {
+    cosTheta = 1. - (1. - cosCone)*G4UniformRand();
+    G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    G4double phi = twopi*G4UniformRand();
+    direction.set(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    direction.rotateUz(axis);
+  }
+  else {
+    cosTheta = 1. - 2.*G4UniformRand();
+    G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    G4double phi = twopi*G4UniformRand();
+    direction.set(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    cosTheta = direction.dot(axis);
+  }
+
+  // Density per unit solid angle
+  density = (1. - fBiasFraction)/(4.*pi);
+  if (cosTheta >= cosCone) density += fBiasFraction/(twopi*(1. - cosCone));
+  return direction;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/source/", "Primary source control");
+
+  fMessenger->DeclareProperty("bias", fBias,
+    "Bias the primary direction towards biasTarget, with event weights.");
+
+  auto& targetCmd
+    = fMessenger->DeclarePropertyWithUnit("biasTarget", "cm", fBiasTarget,
+        "Point the biased directions aim at (default: scintillator).");
+  targetCmd.SetParameterName("x", "y", "z", true);
+
+  auto& coneCmd
+    = fMessenger->DeclarePropertyWithUnit("biasConeAngle", "deg",
+        fBiasConeAngle, "Half-angle of the biased cone.");
+  coneCmd.SetParameterName("angle", true);
+  coneCmd.SetRange("angle>0. && angle<=180.");
+
+  auto& fractionCmd
+    = fMessenger->DeclareProperty("biasFraction", fBiasFraction,
+        "Probability to sample the direction in the cone.");
+  fractionCmd.SetParameterName("fraction", true);
+  fractionCmd.SetRange("fraction>=0. && fraction<1.");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,209 @@
+/// \file ProgressMonitor.cc
+/// \brief Implementation of the ProgressMonitor class
+
+#include "ProgressMonitor.hh"
+#include "StartupTimer.hh"
+
+#include "G4Run.hh"
+#include "G4Threading.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // Counters of the shard, shared by the threads of the process; the
+  // master sets them up before the workers start the run
+  std::atomic<G4long> gRunEventsDone(0);
+  std::atomic<G4long> gJobEvents(0);
+  std::atomic<G4long> gJobDone(0);
+  std::atomic<G4bool> gJobSet(false);
+
+  // Appending to the status file
+  std::mutex gStatusMutex;
+
+  std::string HostName()
+  {
+    char name[256] = "unknown";
+    gethostname(name, sizeof(name) - 1);
+    return name;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMonitor::ProgressMonitor()
+ : fMessenger(0),
+   fInterval(60.*s),
+   fShard(0),
+   fRunID(0),
+   fInRun(false),
+   fNofEvents(0),
+   fNofSteps(0.),
+   fLastEvents(0),
+   fLastSteps(0.)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMonitor::~ProgressMonitor()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::SetJob(G4long nEvents, G4long nDone)
+{
+  gJobEvents = nEvents;
+  gJobDone = nDone;
+  gJobSet = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::BeginOfRun(const G4Run* run, G4bool isMaster,
+                                 G4int shard, const G4String& dataFile,
+                                 const G4String& outputFile)
+{
+  if (isMaster) {
+    gRunEventsDone = 0;
+    if (!gJobSet) {
+      // A plain /run/beamOn is the whole job
+      gJobEvents = run->GetNumberOfEventToBeProcessed();
+      gJobDone = 0;
+    }
+  }
+
+  fStatusFile = fFileName;
+  if (fStatusFile.empty()) {
+    fStatusFile = dataFile;
+    if (fStatusFile.size() > 5
+        && fStatusFile.compare(fStatusFile.size() - 5, 5, ".root") == 0) {
+      fStatusFile.erase(fStatusFile.size() - 5);
+    }
+    fStatusFile += ".status";
+  }
+  fOutputFile = outputFile;
+  fShard = shard;
+  fRunID = run->GetRunID();
+  fInRun = true;
+  fNofEvents = 0;
+  fNofSteps = 0.;
+  fLastEvents = 0;
+  fLastSteps = 0.;
+  fRunStart = fLastReport = std::chrono::steady_clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::EndOfEvent(G4double nSteps)
+{
+  ++fNofEvents;
+  fNofSteps = nSteps;
+  ++gRunEventsDone;
+  if (fInterval <= 0.) return;
+  auto now = std::chrono::steady_clock::now();
+  if (std::chrono::duration<G4double>(now - fLastReport).count()
+      >= fInterval/s) {
+    Report(now);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::EndOfRun(G4bool isMaster)
+{
+  // A final record from the threads which processed events
+  if (fInRun && fNofEvents > 0 && fInterval > 0.) {
+    Report(std::chrono::steady_clock::now());
+  }
+  fInRun = false;
+  // The next plain /run/beamOn is a job of its own
+  if (isMaster) gJobSet = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::Report(std::chrono::steady_clock::time_point now)
+{
+  static const std::string host = HostName();
+
+  G4double interval
+    = std::chrono::duration<G4double>(now - fLastReport).count();
+  G4double elapsed = std::chrono::duration<G4double>(now - fRunStart).count();
+  G4double eventRate
+    = interval > 0. ? (fNofEvents - fLastEvents)/interval : 0.;
+  G4double stepRate = interval > 0. ? (fNofSteps - fLastSteps)/interval : 0.;
+  G4long runDone = gRunEventsDone;
+  G4long jobDone = gJobDone + runDone;
+  G4long jobEvents = gJobEvents;
+  G4double shardRate = elapsed > 0. ? runDone/elapsed : 0.;
+  G4double eta = shardRate > 0. ? (jobEvents - jobDone)/shardRate : -1.;
+  G4int thread = G4Threading::G4GetThreadId();
+  if (thread < 0) thread = 0;
+
+  struct stat fileStat;
+  long long outputBytes = 0;
+  if (stat(fOutputFile.c_str(), &fileStat) == 0) {
+    outputBytes = fileStat.st_size;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(gStatusMutex);
+    std::ofstream out(fStatusFile, std::ios::app);
+    out << "{\"time\": " << std::time(nullptr)
+        << ", \"host\": \"" << host << "\""
+        << ", \"shard\": " << fShard
+        << ", \"thread\": " << thread
+        << ", \"run\": " << fRunID
+        << ", \"events\": " << fNofEvents
+        << ", \"events_per_s\": " << eventRate
+        << ", \"steps_per_s\": " << stepRate
+        << ", \"job_events\": " << jobDone
+        << ", \"job_total\": " << jobEvents
+        << ", \"job_events_per_s\": " << shardRate
+        << ", \"eta_s\": " << eta
+        << ", \"rss_kb\": " << StartupTimer::ResidentKB()
+        << ", \"output_bytes\": " << outputBytes
+        << "}" << std::endl;
+  }
+  if (thread == 0) {
+    G4cout << "Progress: " << jobDone << "/" << jobEvents << " events, "
+           << shardRate << " events/s, ETA " << eta << " s" << G4endl;
+  }
+
+  fLastReport = now;
+  fLastEvents = fNofEvents;
+  fLastSteps = fNofSteps;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMonitor::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/progress/", "Progress reports");
+
+  auto& intervalCmd
+    = fMessenger->DeclarePropertyWithUnit("interval", "s", fInterval,
+        "Time between two status records of a thread (0 = off).");
+  intervalCmd.SetParameterName("interval", false);
+  intervalCmd.SetRange("interval>=0.");
+
+  auto& fileCmd
+    = fMessenger->DeclareProperty("file", fFileName,
+        "Status file (default: output file with .status).");
+  fileCmd.SetParameterName("file", false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,104 @@
+/// \file RegionSecondaries.cc
+/// \brief Implementation of the RegionSecondaries class
+
+#include "RegionSecondaries.hh"
+#include "DetectorRegions.hh"
+
+#include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RegionSecondaries::RegionSecondaries()
+ : fNames(DetectorRegions::Names())
+{
+  fNames.push_back("other");
+
+  // Reserve first: the accumulables are registered by address
+  const size_t nCounts = fNames.size()*kNofParticles;
+  fCounts.reserve(nCounts);
+  auto accumulableManager = G4AccumulableManager::Instance();
+  for (size_t i = 0; i < nCounts; ++i) {
+    fCounts.emplace_back(0.);
+    accumulableManager->RegisterAccumulable(fCounts[i]);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int RegionSecondaries::RegionIndex(const G4Region* region)
+{
+  // The regions are never deleted; the master builds its actions before
+  // they exist, so they are looked up when first needed
+  if (fRegions.empty()) {
+    for (const auto& name : DetectorRegions::Names()) {
+      fRegions.push_back(G4RegionStore::GetInstance()->GetRegion(name, false));
+    }
+  }
+  for (size_t i = 0; i < fRegions.size(); ++i) {
+    if (region && fRegions[i] == region) return i;
+  }
+  return fRegions.size();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RegionSecondaries::Count(const G4Track* track)
+{
+  // Secondaries carry the touchable of their creation point
+  G4VPhysicalVolume* volume = track->GetVolume();
+  if (!volume) return;
+  G4int region = RegionIndex(volume->GetLogicalVolume()->GetRegion());
+
+  const G4ParticleDefinition* particle = track->GetDefinition();
+  Particle type = kOther;
+  if (particle == G4Gamma::Definition()) type = kGamma;
+  else if (particle == G4Electron::Definition()) type = kElectron;
+  else if (particle == G4Positron::Definition()) type = kPositron;
+  fCounts[region*kNofParticles + type] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RegionSecondaries::Print() const
+{
+  const char* particles[kNofParticles] = { "gamma", "e-", "e+", "other" };
+  G4cout << G4endl << "----------------Secondaries per region----------------"
+         << G4endl << " " << std::setw(8) << "region";
+  for (auto particle : particles) G4cout << std::setw(12) << particle;
+  G4cout << std::setw(12) << "total" << "   cut" << G4endl;
+  for (size_t i = 0; i < fNames.size(); ++i) {
+    G4double total = 0.;
+    G4cout << " " << std::setw(8) << fNames[i];
+    for (G4int j = 0; j < kNofParticles; ++j) {
+      G4double count = fCounts[i*kNofParticles + j].GetValue();
+      total += count;
+      G4cout << std::setw(12) << count;
+    }
+    G4cout << std::setw(12) << total << "   ";
+    const G4Region* region
+      = i + 1 < fNames.size()
+          ? G4RegionStore::GetInstance()->GetRegion(fNames[i], false) : nullptr;
+    if (region && region->GetProductionCuts()) {
+      G4cout << G4BestUnit(region->GetProductionCuts()->GetProductionCut(0),
+                           "Length");
+    }
+    else {
+      G4cout << "global";
+    }
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
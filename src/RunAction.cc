@@ -30,6 +30,16 @@
 #include "RunAction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "TrackKillPolicy.hh"
+#include "SteppingProfiler.hh"
+#include "NtupleWriter.hh"
+#include "EventTrigger.hh"
+#include "PhaseSpaceRecorder.hh"
+#include "ProgressMonitor.hh"
+#include "EventHistograms.hh"
+#include "RegionSecondaries.hh"
+#include "StartupTimer.hh"
+#include "PhysicsTableCache.hh"
 // #include "Run.hh"
 
 #include "G4Run.hh"
@@ -44,43 +54,172 @@
 #include "G4LogicalVolume.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
+
+#include <fstream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+namespace {
+  // out/run.root -> out/run<suffix>.root
+  G4String InsertSuffix(G4String fileName, const G4String& suffix)
+  {
+    if (fileName.size() > 5
+        && fileName.compare(fileName.size() - 5, 5, ".root") == 0) {
+      fileName.erase(fileName.size() - 5);
+    }
+    return fileName + suffix + ".root";
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 //G4String m_hDataFilename;
-RunAction::RunAction()
+RunAction::RunAction(OutputMode mode)
+: fOutputMode(mode),
+  fShard(0),
+  fCheckpointInterval(0),
+  fEventOffset(0),
+  fKillPolicy(new TrackKillPolicy),
+  fProfiler(new SteppingProfiler),
+  fWriter(new NtupleWriter),
+  fTrigger(new EventTrigger),
+  fRecorder(new PhaseSpaceRecorder),
+  fProgress(new ProgressMonitor),
+  fHistograms(new EventHistograms),
+  fSecondaries(new RegionSecondaries),
+  fNofSteps(0.)
 { 
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNofSteps);
+
   auto analysisManager = G4AnalysisManager::Instance();
  // G4AccumulableManager* analysisManager = G4AccumulableManager::Instance();
   analysisManager->SetVerboseLevel(1);
   analysisManager->SetNtupleMerging(true);
 
-  analysisManager->CreateNtuple("event", "Energy and Position");
-  analysisManager->CreateNtupleDColumn("Energy");
-  analysisManager->CreateNtupleDColumn("prex");
-  analysisManager->CreateNtupleDColumn("prey");
-  analysisManager->CreateNtupleDColumn("prez");
-  analysisManager->CreateNtupleDColumn("postx");   
-  analysisManager->CreateNtupleDColumn("posty");    //5
-  analysisManager->CreateNtupleDColumn("postz");
-  analysisManager->CreateNtupleSColumn("ptype");
-  analysisManager->CreateNtupleDColumn("eventID");
-  analysisManager->CreateNtupleDColumn("trackID");
-  analysisManager->CreateNtupleDColumn("parentID");  //10
-  analysisManager->CreateNtupleDColumn("dE"); 
+  // Schema v3: species as PDG code, IDs and counters as int, energies (keV)
+  // and positions (mm) as float. eventID is the event number within the
+  // shard; ((Long64_t) shard << 32) | eventID is the 64-bit event ID,
+  // unique over all shards of a job. The last column is the statistical
+  // weight of the track (1 without biasing).
+  G4String version = " (schema v" + std::to_string(kSchemaVersion) + ")";
+  if (fOutputMode == OutputMode::None) return;
+  if (fOutputMode == OutputMode::Step) {
+    analysisManager->CreateNtuple("event", "Energy and Position" + version);
+    analysisManager->CreateNtupleFColumn("Energy");
+    analysisManager->CreateNtupleFColumn("prex");
+    analysisManager->CreateNtupleFColumn("prey");
+    analysisManager->CreateNtupleFColumn("prez");
+    analysisManager->CreateNtupleFColumn("postx");   
+    analysisManager->CreateNtupleFColumn("posty");    //5
+    analysisManager->CreateNtupleFColumn("postz");
+    analysisManager->CreateNtupleIColumn("pdg");
+    analysisManager->CreateNtupleIColumn("eventID");
+    analysisManager->CreateNtupleIColumn("trackID");
+    analysisManager->CreateNtupleIColumn("parentID");  //10
+    analysisManager->CreateNtupleFColumn("dE"); 
+    analysisManager->CreateNtupleIColumn("shard");
+    analysisManager->CreateNtupleFColumn("weight");
+    analysisManager->FinishNtuple();
+    return;
+  }
+
+  // Summary rows: energy at entry, entry and exit points, total deposit,
+  // number of interactions and steps inside DetectorTub
+  if (fOutputMode == OutputMode::Track) {
+    analysisManager->CreateNtuple("track",
+                                  "Tracks entering DetectorTub" + version);
+  }
+  else {
+    analysisManager->CreateNtuple("summary",
+                                  "Events with DetectorTub hits" + version);
+  }
+  analysisManager->CreateNtupleFColumn("Energy");
+  analysisManager->CreateNtupleFColumn("entryx");
+  analysisManager->CreateNtupleFColumn("entryy");
+  analysisManager->CreateNtupleFColumn("entryz");
+  analysisManager->CreateNtupleFColumn("exitx");
+  analysisManager->CreateNtupleFColumn("exity");    //5
+  analysisManager->CreateNtupleFColumn("exitz");
+  analysisManager->CreateNtupleFColumn("dE");
+  analysisManager->CreateNtupleIColumn("nScatter");
+  analysisManager->CreateNtupleIColumn("nStep");
+  analysisManager->CreateNtupleIColumn("eventID");  //10
+  analysisManager->CreateNtupleIColumn("shard");
+  if (fOutputMode == OutputMode::Track) {
+    analysisManager->CreateNtupleIColumn("pdg");
+    analysisManager->CreateNtupleIColumn("trackID");
+    analysisManager->CreateNtupleIColumn("parentID");
+  }
+  else {
+    analysisManager->CreateNtupleIColumn("nTrack");
+  }
+  analysisManager->CreateNtupleFColumn("weight");
   analysisManager->FinishNtuple();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::~RunAction()
-{}
+{
+  delete fKillPolicy;
+  delete fProfiler;
+  delete fWriter;
+  delete fTrigger;
+  delete fRecorder;
+  delete fProgress;
+  delete fHistograms;
+  delete fSecondaries;
+  delete G4AnalysisManager::Instance();
+}
 
-void RunAction::BeginOfRunAction(const G4Run*)
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
+  // The master builds (or retrieves) the physics tables just before its
+  // first run starts
+  if (IsMaster()) {
+    StartupTimer::Mark(PhysicsTableCache::IsRetrieved()
+                       ? "physics tables (retrieved)" : "physics tables");
+  }
+  fRunStart = std::chrono::steady_clock::now();
+  // The geometry may have been rebuilt since the last run (/toy/det/)
+  fKillPolicy->ResetVolumes();
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
+  G4AccumulableManager::Instance()->Reset();
   auto analysisManager = G4AnalysisManager::Instance();
 
-  G4String filename = m_hDataFilename;//"event.root";
-  analysisManager->OpenFile(filename);
+  fFileName = m_hDataFilename;//"event.root";
+  fEventOffset = 0;
+  G4String suffix;
+  // Files of a configuration scan (/toy/det/ commands) are tagged,
+  // out/run.root -> out/run_EJ276_30deg_45.72mm.root
+  auto detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (detector->IsModified()) {
+    suffix += "_" + detector->GetConfigurationTag();
+  }
+  // A checkpointed job writes every segment to its own file,
+  // out/run_0007.root -> out/run_0007_seg0003.root, so that the segments
+  // already closed survive the job being killed
+  if (fCheckpointInterval > 0) {
+    // Workers count their runs themselves, the master run is the segment
+    G4int segment = run->GetRunID();
+#ifdef G4MULTITHREADED
+    if (!IsMaster()) {
+      segment = G4MTRunManager::GetMasterRunManager()->GetCurrentRun()
+                  ->GetRunID();
+    }
+#endif
+    std::string index = std::to_string(segment);
+    if (index.size() < 4) index.insert(0, 4 - index.size(), '0');
+    suffix += "_seg" + index;
+    fEventOffset = segment*fCheckpointInterval;
+  }
+  if (!suffix.empty()) fFileName = InsertSuffix(fFileName, suffix);
+  analysisManager->OpenFile(fFileName);
+  fRecorder->BeginOfRun(IsMaster(), fFileName, suffix);
+  fProgress->BeginOfRun(run, IsMaster(), fShard, m_hDataFilename, fFileName);
   G4cout << "Using " << analysisManager->GetType() << G4endl;
 
 
@@ -89,11 +228,93 @@ void RunAction::BeginOfRunAction(const G4Run*)
 
 void RunAction::EndOfRunAction(const G4Run* run)
 {
-  G4int nofEvents = run->GetNumberOfEvent();
-  if (nofEvents == 0) return;
+  // The file was opened by every thread in BeginOfRunAction, so each one
+  // has to close it, even a worker which got no events: with ntuple
+  // merging the master waits for the rows of all workers. The rows still
+  // in the output buffer go first.
+  fWriter->Flush();
+  fProgress->EndOfRun(IsMaster());
   auto analysisManager = G4AnalysisManager::Instance();
   analysisManager->Write();
   analysisManager->CloseFile();
+
+  // Sum the counters of the workers into the master
+  G4AccumulableManager::Instance()->Merge();
+  fRecorder->EndOfRun(run, IsMaster());
+
+  if (IsMaster()) {
+    G4cout << "--------------------End of Global Run-----------------------"
+           << G4endl
+           << " The run consists of " << run->GetNumberOfEvent() << " events"
+           << G4endl;
+    fKillPolicy->Print();
+    fSecondaries->Print();
+    fTrigger->Print();
+    fProfiler->Print();
+    if (!fBenchFile.empty()) WriteBenchmark(run);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteBenchmark(const G4Run* run) const
+{
+  // One JSON record per run: configuration, then throughput, steps per
+  // event, peak resident memory of the process and size of the output
+  // file, and the time and memory of building the physics tables
+  G4double seconds = std::chrono::duration<G4double>(
+                       std::chrono::steady_clock::now() - fRunStart).count();
+  G4int nEvents = run->GetNumberOfEvent();
+  G4int nThreads = 1;
+#ifdef G4MULTITHREADED
+  auto mtRunManager
+    = dynamic_cast<G4MTRunManager*>(G4RunManager::GetRunManager());
+  if (mtRunManager) nThreads = mtRunManager->GetNumberOfThreads();
+#endif
+  auto detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  const char* outputModes[] = { "step", "track", "event", "none" };
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  struct stat fileStat;
+  long long outputBytes = 0;
+  if (stat(fFileName.c_str(), &fileStat) == 0) {
+    outputBytes = fileStat.st_size;
+  }
+  G4double perEvent = nEvents > 0 ? 1./nEvents : 0.;
+  G4double tableSeconds = 0.;
+  long tableResident = 0;
+  if (!StartupTimer::GetPhase("physics tables", tableSeconds, tableResident)) {
+    StartupTimer::GetPhase("physics tables (retrieved)", tableSeconds,
+                           tableResident);
+  }
+
+  std::ofstream out(fBenchFile, std::ios::app);
+  out << "{\"name\": \"" << fBenchName << "\""
+      << ", \"threads\": " << nThreads
+      << ", \"geometry\": \"" << detector->GetGeometryName() << "\""
+      << ", \"config\": \"" << detector->GetConfigurationTag() << "\""
+      << ", \"output\": \"" << outputModes[(G4int) fOutputMode] << "\""
+      << ", \"physics_list\": \"" << fPhysicsListName << "\""
+      << ", \"schema\": " << kSchemaVersion
+      << ", \"events\": " << nEvents
+      << ", \"wall_s\": " << seconds
+      << ", \"events_per_s\": " << (seconds > 0. ? nEvents/seconds : 0.)
+      << ", \"steps_per_event\": " << fNofSteps.GetValue()*perEvent
+      << ", \"peak_rss_kb\": " << usage.ru_maxrss
+      << ", \"output_bytes\": " << outputBytes
+      << ", \"bytes_per_event\": " << outputBytes*perEvent
+      << ", \"physics_tables_s\": " << tableSeconds
+      << ", \"physics_tables_rss_kb\": " << tableResident
+      << "}" << std::endl;
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the benchmark record to " << fBenchFile;
+    G4Exception("RunAction::WriteBenchmark()", "toyMC001", JustWarning, msg);
+    return;
+  }
+  G4cout << " Benchmark record appended to " << fBenchFile << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
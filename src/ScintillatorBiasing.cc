@@ -0,0 +1,61 @@
+/// \file ScintillatorBiasing.cc
+/// \brief Implementation of the ScintillatorBiasing class
+
+#include "ScintillatorBiasing.hh"
+#include "DetectorConstruction.hh"
+#include "PhysicsTableCache.hh"
+
+#include "G4VModularPhysicsList.hh"
+#include "G4GenericBiasingPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ApplicationState.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScintillatorBiasing::ScintillatorBiasing(G4VModularPhysicsList* physicsList,
+                                         DetectorConstruction* detector)
+ : fMessenger(0),
+   fPhysicsList(physicsList),
+   fDetector(detector),
+   fRegistered(false)
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/biasing/",
+                             "Generic biasing in the Scintillator");
+
+  auto& forceCmd
+    = fMessenger->DeclareMethod("forceCollision",
+        &ScintillatorBiasing::SetForceCollision,
+        "Force neutrons entering the Scintillator to interact in it"
+        " (before /run/initialize).");
+  forceCmd.SetParameterName("enable", true);
+  forceCmd.SetDefaultValue("true");
+  forceCmd.AvailableForStates(G4State_PreInit);
+  forceCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScintillatorBiasing::~ScintillatorBiasing()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScintillatorBiasing::SetForceCollision(G4bool enable)
+{
+  // The biasing physics wraps the neutron processes; it is only added
+  // when needed, as the wrappers cost time in every volume
+  if (enable && !fRegistered) {
+    auto biasingPhysics = new G4GenericBiasingPhysics();
+    biasingPhysics->Bias("neutron");
+    fPhysicsList->RegisterPhysics(biasingPhysics);
+    fRegistered = true;
+    PhysicsTableCache::Cancel("the biasing physics wraps the neutron"
+                              " processes");
+  }
+  fDetector->SetForceCollision(enable);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,43 @@
+/// \file StackingAction.cc
+/// \brief Implementation of the StackingAction class
+
+#include "StackingAction.hh"
+#include "TrackKillPolicy.hh"
+#include "RegionSecondaries.hh"
+
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction(TrackKillPolicy* killPolicy,
+                               RegionSecondaries* secondaries)
+ : G4UserStackingAction(),
+   fKillPolicy(killPolicy),
+   fSecondaries(secondaries)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::~StackingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack
+StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if (track->GetParentID() > 0) fSecondaries->Count(track);
+  if (!fKillPolicy->IsActive()) return fUrgent;
+
+  // Secondaries carry the touchable of their creation point; primaries
+  // have none yet and are only checked for energy and time
+  G4VPhysicalVolume* volume = track->GetVolume();
+  if (fKillPolicy->Kill(track, volume ? volume->GetLogicalVolume() : 0)) {
+    return fKill;
+  }
+  return fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
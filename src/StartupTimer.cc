@@ -0,0 +1,90 @@
+/// \file StartupTimer.cc
+/// \brief Implementation of the StartupTimer class
+
+#include "StartupTimer.hh"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  std::mutex gMutex;
+  Clock::time_point gStart = Clock::now();
+  Clock::time_point gLast = gStart;
+  long gLastResident = 0;
+
+  struct Phase {
+    G4double seconds;
+    long residentKB;
+  };
+  std::map<G4String, Phase> gPhases;
+
+  G4double Seconds(Clock::duration d)
+  {
+    return std::chrono::duration<G4double>(d).count();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupTimer::Start()
+{
+  std::lock_guard<std::mutex> lock(gMutex);
+  gStart = gLast = Clock::now();
+  gLastResident = ResidentKB();
+  gPhases.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupTimer::Mark(const G4String& phase)
+{
+  std::lock_guard<std::mutex> lock(gMutex);
+  if (gPhases.count(phase)) return;
+  Clock::time_point now = Clock::now();
+  long resident = ResidentKB();
+  gPhases[phase] = { Seconds(now - gLast), resident };
+  std::ios::fmtflags flags = G4cout.flags();
+  std::streamsize precision = G4cout.precision(3);
+  G4cout << "Startup: " << std::setw(16) << std::left << phase << std::right
+         << std::fixed << std::setw(9) << Seconds(now - gLast)
+         << " s  (total " << Seconds(now - gStart) << " s)  rss "
+         << resident/1024 << " MB (+" << (resident - gLastResident)/1024
+         << " MB)" << G4endl;
+  G4cout.flags(flags);
+  G4cout.precision(precision);
+  gLast = now;
+  gLastResident = resident;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StartupTimer::GetPhase(const G4String& phase, G4double& seconds,
+                              long& residentKB)
+{
+  std::lock_guard<std::mutex> lock(gMutex);
+  auto it = gPhases.find(phase);
+  if (it == gPhases.end()) return false;
+  seconds = it->second.seconds;
+  residentKB = it->second.residentKB;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+long StartupTimer::ResidentKB()
+{
+  long pages = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident*(sysconf(_SC_PAGESIZE)/1024);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,192 @@
+/// \file SteppingProfiler.cc
+/// \brief Implementation of the SteppingProfiler class
+
+#include "SteppingProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  struct Row {
+    G4String name;
+    G4long   nTracks = 0;
+    G4long   nSteps = 0;
+    G4double time = 0.;
+  };
+
+  void PrintRows(const G4String& title, std::vector<Row> rows,
+                 G4double totalTime)
+  {
+    std::sort(rows.begin(), rows.end(),
+              [](const Row& a, const Row& b) { return a.time > b.time; });
+    G4cout << G4endl << " " << std::left << std::setw(36) << title
+           << std::right << std::setw(12) << "tracks" << std::setw(14)
+           << "steps" << std::setw(11) << "time [s]" << std::setw(8) << "%"
+           << std::setw(10) << "us/step" << G4endl;
+    for (const auto& row : rows) {
+      G4cout << " " << std::left << std::setw(36) << row.name << std::right
+             << std::setw(12) << row.nTracks << std::setw(14) << row.nSteps
+             << std::setw(11) << row.time
+             << std::setw(8) << (totalTime > 0. ? 100.*row.time/totalTime : 0.)
+             << std::setw(10)
+             << (row.nSteps > 0 ? 1e6*row.time/row.nSteps : 0.) << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingProfiler::SteppingProfiler()
+ : G4VAccumulable("SteppingProfiler"),
+   fMessenger(0),
+   fActive(false),
+   fLastKey(nullptr, nullptr),
+   fLastEntry(nullptr)
+{
+  G4AccumulableManager::Instance()->RegisterAccumulable(this);
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingProfiler::~SteppingProfiler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingProfiler::Entry&
+SteppingProfiler::Lookup(const G4LogicalVolume* volume,
+                         const G4ParticleDefinition* particle)
+{
+  Key key(volume, particle);
+  if (!fLastEntry || key != fLastKey) {
+    fLastKey = key;
+    fLastEntry = &fEntries[key];
+  }
+  return *fLastEntry;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::StartTrack(const G4Track* track)
+{
+  G4VPhysicalVolume* volume = track->GetVolume();
+  Lookup(volume ? volume->GetLogicalVolume() : nullptr,
+         track->GetDefinition()).nTracks += 1;
+  fLastTime = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Step(const G4Step* step)
+{
+  Clock::time_point now = Clock::now();
+  G4VPhysicalVolume* volume = step->GetPreStepPoint()->GetPhysicalVolume();
+  Entry& entry = Lookup(volume ? volume->GetLogicalVolume() : nullptr,
+                        step->GetTrack()->GetDefinition());
+  entry.nSteps += 1;
+  entry.time += std::chrono::duration<G4double>(now - fLastTime).count();
+  fLastTime = now;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Merge(const G4VAccumulable& other)
+{
+  const auto& worker = static_cast<const SteppingProfiler&>(other);
+  for (const auto& item : worker.fEntries) {
+    Entry& entry = fEntries[item.first];
+    entry.nTracks += item.second.nTracks;
+    entry.nSteps += item.second.nSteps;
+    entry.time += item.second.time;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Reset()
+{
+  fEntries.clear();
+  fLastEntry = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Print() const
+{
+  if (!fActive) return;
+
+  // Totals per volume, per particle, and the volume-particle pairs
+  std::map<G4String, Row> volumes, particles;
+  std::vector<Row> pairs;
+  G4double totalTime = 0.;
+  for (const auto& item : fEntries) {
+    G4String volume = item.first.first ? item.first.first->GetName()
+                                       : G4String("(none)");
+    G4String particle = item.first.second->GetParticleName();
+    const Entry& entry = item.second;
+    for (Row* row : { &volumes[volume], &particles[particle] }) {
+      row->nTracks += entry.nTracks;
+      row->nSteps += entry.nSteps;
+      row->time += entry.time;
+    }
+    Row pair;
+    pair.name = volume + " / " + particle;
+    pair.nTracks = entry.nTracks;
+    pair.nSteps = entry.nSteps;
+    pair.time = entry.time;
+    pairs.push_back(pair);
+    totalTime += entry.time;
+  }
+
+  std::vector<Row> volumeRows, particleRows;
+  for (auto& item : volumes) {
+    item.second.name = item.first;
+    volumeRows.push_back(item.second);
+  }
+  for (auto& item : particles) {
+    item.second.name = item.first;
+    particleRows.push_back(item.second);
+  }
+
+  std::ios::fmtflags flags = G4cout.flags();
+  std::streamsize precision = G4cout.precision(3);
+  G4cout << std::fixed << G4endl
+         << "--------------------Stepping profile--------------------"
+         << G4endl << " Total stepping time " << totalTime << " s"
+         << " (summed over threads)" << G4endl;
+  PrintRows("volume", volumeRows, totalTime);
+  PrintRows("particle", particleRows, totalTime);
+  PrintRows("volume / particle", pairs, totalTime);
+  G4cout.flags(flags);
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/profile/", "Stepping profiler");
+
+  auto& enableCmd
+    = fMessenger->DeclareProperty("enable", fActive,
+        "Profile steps, tracks and time per volume and particle.");
+  enableCmd.SetParameterName("enable", true);
+  enableCmd.SetDefaultValue("true");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,155 @@
+/// \file TrackKillPolicy.cc
+/// \brief Implementation of the TrackKillPolicy class
+
+#include "TrackKillPolicy.hh"
+
+#include "G4Track.hh"
+#include "G4Neutron.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackKillPolicy::TrackKillPolicy()
+ : fMessenger(0),
+   fResolved(true),
+   fEnergyThreshold(0.),
+   fTimeCut(0.)
+{
+  // Reserve first: the accumulables are registered by address
+  fNofKilled.reserve(kNofReasons);
+  fKilledWeight.reserve(kNofReasons);
+  fKilledEnergy.reserve(kNofReasons);
+  auto accumulableManager = G4AccumulableManager::Instance();
+  for (G4int i = 0; i < kNofReasons; ++i) {
+    fNofKilled.emplace_back(0.);
+    fKilledWeight.emplace_back(0.);
+    fKilledEnergy.emplace_back(0.);
+    accumulableManager->RegisterAccumulable(fNofKilled[i]);
+    accumulableManager->RegisterAccumulable(fKilledWeight[i]);
+    accumulableManager->RegisterAccumulable(fKilledEnergy[i]);
+  }
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackKillPolicy::~TrackKillPolicy()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TrackKillPolicy::Kill(const G4Track* track,
+                             const G4LogicalVolume* volume)
+{
+  if (fTimeCut > 0. && track->GetGlobalTime() > fTimeCut) {
+    Count(kTime, track);
+    return true;
+  }
+  if (fEnergyThreshold > 0.
+      && track->GetDefinition() == G4Neutron::Definition()
+      && track->GetKineticEnergy() < fEnergyThreshold) {
+    Count(kEnergy, track);
+    return true;
+  }
+  if (volume && !fVolumeNames.empty()) {
+    if (!fResolved) ResolveVolumes();
+    if (std::find(fVolumes.begin(), fVolumes.end(), volume) != fVolumes.end()) {
+      Count(kVolume, track);
+      return true;
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackKillPolicy::AddVolume(const G4String& name)
+{
+  fVolumeNames.push_back(name);
+  fResolved = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackKillPolicy::ResolveVolumes()
+{
+  // Volumes are looked up when first needed, the commands may come
+  // before the geometry is built
+  fVolumes.clear();
+  for (const auto& name : fVolumeNames) {
+    auto volume = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!volume) {
+      G4ExceptionDescription msg;
+      msg << "Kill volume " << name << " not found, ignored.";
+      G4Exception("TrackKillPolicy::ResolveVolumes()", "toyMC001",
+                  JustWarning, msg);
+      continue;
+    }
+    fVolumes.push_back(volume);
+  }
+  fResolved = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackKillPolicy::Count(Reason reason, const G4Track* track)
+{
+  fNofKilled[reason] += 1.;
+  fKilledWeight[reason] += track->GetWeight();
+  fKilledEnergy[reason] += track->GetWeight()*track->GetKineticEnergy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackKillPolicy::Print() const
+{
+  if (!IsActive()) return;
+
+  const char* names[kNofReasons] = { "volume", "energy", "time" };
+  G4cout << G4endl << "--------------------Killed tracks---------------------"
+         << G4endl;
+  for (G4int i = 0; i < kNofReasons; ++i) {
+    G4cout << " " << std::setw(8) << names[i]
+           << " : " << std::setw(12) << fNofKilled[i].GetValue() << " tracks,"
+           << " weight " << std::setw(12) << fKilledWeight[i].GetValue()
+           << ", weighted energy "
+           << G4BestUnit(fKilledEnergy[i].GetValue(), "Energy") << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackKillPolicy::DefineCommands()
+{
+  fMessenger
+    = new G4GenericMessenger(this, "/toy/kill/", "Track killing policy");
+
+  auto& volumeCmd
+    = fMessenger->DeclareMethod("volume", &TrackKillPolicy::AddVolume,
+        "Kill tracks born in or entering this logical volume.");
+  volumeCmd.SetParameterName("name", false);
+
+  auto& energyCmd
+    = fMessenger->DeclarePropertyWithUnit("energyThreshold", "keV",
+        fEnergyThreshold, "Kill neutrons below this energy (0 = off).");
+  energyCmd.SetParameterName("energy", false);
+  energyCmd.SetRange("energy>=0.");
+
+  auto& timeCmd
+    = fMessenger->DeclarePropertyWithUnit("timeCut", "ns", fTimeCut,
+        "Kill tracks after this global time (0 = off).");
+  timeCmd.SetParameterName("time", false);
+  timeCmd.SetRange("time>=0.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -1,88 +1,455 @@
+
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "StartupTimer.hh"
+#include "ScintillatorBiasing.hh"
+#include "DetectorRegions.hh"
+#include "CheckpointManager.hh"
+#include "PhysicsTableCache.hh"
+#include "PhaseSpaceSource.hh"
 
 #ifdef G4MULTITHREADED
 #include "G4MTRunManager.hh"
+#include "G4Threading.hh"
 #else
 #include "G4RunManager.hh"
 #endif
 
 #include "G4UImanager.hh"
-#include "QBBC.hh"
+#include "G4PhysListFactory.hh"
+#include "G4VModularPhysicsList.hh"
 
+// toyMC_batch is built with TOYMC_BATCH: no visualization and no UI
+// session, so that neither the drivers nor their libraries are loaded
+#ifndef TOYMC_BATCH
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
+#endif
 #include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <string>
 #include "Randomize.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " toyMC [-t nThreads] [--shard k/N] [--seed S] [--events n]"
+           << " [--output step|track|event|none] [--geometry boolean|placed]"
+           << " [--gdml file | --gdml-export file] [--no-overlap-check]"
+           << " [--bench file] [--checkpoint n]"
+           << " [--physics-tables dir | --store-physics-tables dir]"
+           << " [--physics-list name]"
+           << " [macro [outfile]]" << G4endl;
+#ifdef G4MULTITHREADED
+    G4cerr << "   -t : number of worker threads, 0 = all cores (default 1)"
+           << G4endl;
+#else
+    G4cerr << "   -t : ignored, Geant4 was built without multithreading"
+           << G4endl;
+#endif
+    G4cerr << "   --shard  : run shard k (0 <= k < N) of an N-shard job" << G4endl;
+    G4cerr << "   --seed   : master seed of the job (default: from clock)"
+           << G4endl;
+    G4cerr << "   --events : total events of the job, split over the shards;"
+           << " exported to the macro as {nEvents} (default 10000000)"
+           << G4endl;
+    G4cerr << "   --output : one ntuple row per detector step (default),"
+           << " per track entering the detector, per event, or none"
+           << " (histograms only)" << G4endl;
+    G4cerr << "   --geometry : AirTee as boolean union (default) or as"
+           << " placed primitives" << G4endl;
+    G4cerr << "   --gdml : read the geometry and materials from a GDML file,"
+           << " without overlap checks" << G4endl;
+    G4cerr << "   --gdml-export : build the geometry with overlap checks,"
+           << " write it to a GDML file and exit" << G4endl;
+    G4cerr << "   --no-overlap-check : skip the overlap checks of the geometry"
+           << " built from code" << G4endl;
+    G4cerr << "   --bench : append a benchmark record (JSON) of every run"
+           << " to the file" << G4endl;
+    G4cerr << "   --checkpoint : /toy/run/beamOn runs segments of n events,"
+           << " one file each, and resumes from <outfile>.ckpt" << G4endl;
+    G4cerr << "   --physics-tables : retrieve the physics tables from dir,"
+           << " or build them if they are stale" << G4endl;
+    G4cerr << "   --store-physics-tables : build the physics tables, store"
+           << " them in dir and exit" << G4endl;
+    G4cerr << "   --physics-list : reference physics list, e.g. QGSP_BIC_HP"
+           << " or FTFP_BERT_HP_EMZ (default QBBC)" << G4endl;
+#ifdef TOYMC_BATCH
+    G4cerr << " toyMC_batch has no interactive session and needs a macro."
+           << G4endl;
+#else
+    G4cerr << " Without a macro an interactive session is started." << G4endl;
+#endif
+  }
+
+  // Give every (master seed, shard) pair its own MixMax stream. MixMax
+  // streams with different seed words are independent, so shards never
+  // share random numbers however many of them are started at once.
+  void SeedShard(unsigned long long masterSeed, G4int shard)
+  {
+    long seeds[4];
+    seeds[0] = (long) (masterSeed >> 32);
+    seeds[1] = (long) (masterSeed & 0xffffffffULL);
+    seeds[2] = shard;
+    seeds[3] = 0;
+    auto engine = new CLHEP::MixMaxRng;
+    engine->setSeeds(seeds, 4);
+    CLHEP::HepRandom::setTheEngine(engine);
+  }
+
+  // A whole non-negative decimal number, false for anything else
+  G4bool ParseNumber(const char* text, unsigned long long& value)
+  {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0 && text[0] != '-';
+  }
+
+  // High precision neutron lists read the G4NDL data set
+  G4bool IsHighPrecision(const G4String& physicsListName)
+  {
+    return physicsListName.find("_HP") != std::string::npos
+           || (physicsListName.find("Shielding") == 0
+               && physicsListName.find("LEND") == std::string::npos);
+  }
+
+  // Check the physics list before anything is built, so that a job with
+  // a wrong name or a missing data set fails at once
+  G4bool CheckPhysicsList(const G4String& physicsListName)
+  {
+    G4PhysListFactory factory;
+    if ( ! factory.IsReferencePhysList(physicsListName) ) {
+      G4cerr << "Unknown physics list " << physicsListName << G4endl;
+      factory.AvailablePhysLists();
+      return false;
+    }
+    if ( IsHighPrecision(physicsListName)
+         && ! std::getenv("G4NEUTRONHPDATA") ) {
+      G4cerr << "Physics list " << physicsListName << " needs the neutron"
+             << " data set, G4NEUTRONHPDATA is not set" << G4endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  StartupTimer::Start();
+
+  // Parse command line: options first, then macro and output file name
+  //
+  G4String macro;
+  G4String outfile;
+  G4int nThreads = 1;
+  G4int shard = 0, nShards = 1;
+  G4bool sharded = false;
+  G4bool seeded = false;
+  unsigned long long masterSeed = 0;
+  G4long nTotalEvents = 10000000;
+  OutputMode outputMode = OutputMode::Step;
+  GeometryMode geometryMode = GeometryMode::Boolean;
+  G4String gdmlFile, gdmlExport;
+  G4bool checkOverlaps = true;
+  G4String benchFile;
+  G4int checkpointInterval = 0;
+  G4String tableDir, storeTableDir;
+  G4String physicsListName = "QBBC";
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String arg = argv[i];
+    if ( arg == "-t" && i+1 < argc ) {
+      unsigned long long threads;
+      if ( ! ParseNumber(argv[++i], threads) || threads > INT_MAX ) {
+        G4cerr << "Invalid number of threads " << argv[i] << G4endl;
+        PrintUsage();
+        return 1;
+      }
+      nThreads = threads;
+    }
+    else if ( arg == "--shard" && i+1 < argc ) {
+      // Exactly k/N, both whole numbers
+      std::string text = argv[++i];
+      size_t slash = text.find('/');
+      unsigned long long k, n;
+      if ( slash == std::string::npos
+           || ! ParseNumber(text.substr(0, slash).c_str(), k)
+           || ! ParseNumber(text.substr(slash + 1).c_str(), n)
+           || n < 1 || n > INT_MAX || k >= n ) {
+        G4cerr << "Invalid shard " << argv[i] << ", expected k/N" << G4endl;
+        PrintUsage();
+        return 1;
+      }
+      shard = k;
+      nShards = n;
+      sharded = true;
+    }
+    else if ( arg == "--seed" && i+1 < argc ) {
+      if ( ! ParseNumber(argv[++i], masterSeed) ) {
+        G4cerr << "Invalid seed " << argv[i] << G4endl;
+        PrintUsage();
+        return 1;
+      }
+      seeded = true;
+    }
+    else if ( arg == "--events" && i+1 < argc ) {
+      unsigned long long events;
+      if ( ! ParseNumber(argv[++i], events) || events > LONG_MAX ) {
+        G4cerr << "Invalid number of events " << argv[i] << G4endl;
+        PrintUsage();
+        return 1;
+      }
+      nTotalEvents = events;
+    }
+    else if ( arg == "--output" && i+1 < argc ) {
+      G4String mode = argv[++i];
+      if      ( mode == "step" )  outputMode = OutputMode::Step;
+      else if ( mode == "track" ) outputMode = OutputMode::Track;
+      else if ( mode == "event" ) outputMode = OutputMode::Event;
+      else if ( mode == "none" )  outputMode = OutputMode::None;
+      else {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if ( arg == "--geometry" && i+1 < argc ) {
+      G4String mode = argv[++i];
+      if      ( mode == "boolean" ) geometryMode = GeometryMode::Boolean;
+      else if ( mode == "placed" )  geometryMode = GeometryMode::Placed;
+      else {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if ( arg == "--gdml" && i+1 < argc ) {
+      gdmlFile = argv[++i];
+    }
+    else if ( arg == "--gdml-export" && i+1 < argc ) {
+      gdmlExport = argv[++i];
+    }
+    else if ( arg == "--no-overlap-check" ) {
+      checkOverlaps = false;
+    }
+    else if ( arg == "--bench" && i+1 < argc ) {
+      benchFile = argv[++i];
+    }
+    else if ( arg == "--checkpoint" && i+1 < argc ) {
+      unsigned long long interval;
+      if ( ! ParseNumber(argv[++i], interval) || interval == 0
+           || interval > INT_MAX ) {
+        G4cerr << "Invalid checkpoint interval " << argv[i] << G4endl;
+        PrintUsage();
+        return 1;
+      }
+      checkpointInterval = interval;
+    }
+    else if ( arg == "--physics-tables" && i+1 < argc ) {
+      tableDir = argv[++i];
+    }
+    else if ( arg == "--store-physics-tables" && i+1 < argc ) {
+      storeTableDir = argv[++i];
+    }
+    else if ( arg == "--physics-list" && i+1 < argc ) {
+      physicsListName = argv[++i];
+    }
+    else if ( arg[0] == '-' ) {
+      PrintUsage();
+      return 1;
+    }
+    else if ( macro.empty() ) macro = arg;
+    else if ( outfile.empty() ) outfile = arg;
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  if ( ! CheckPhysicsList(physicsListName) ) return 1;
+
+  // Validate and export the geometry once, for the production jobs to
+  // read with --gdml
   //
+  if ( ! gdmlExport.empty() ) {
+    auto detector = new DetectorConstruction();
+    detector->SetGeometryMode(geometryMode);
+    detector->ExportGdml(gdmlExport);
+    G4cout << "Geometry written to " << gdmlExport << G4endl;
+    delete detector;
+    return 0;
+  }
+
+  // Detect interactive mode (if no macro) and define UI session
+  //
+#ifdef TOYMC_BATCH
+  if ( macro.empty() && storeTableDir.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+#else
   G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  if ( macro.empty() && storeTableDir.empty() ) {
     ui = new G4UIExecutive(argc, argv);
   }
-  struct timeval hTimeValue;
-  gettimeofday(&hTimeValue, NULL);
-  G4int m_hRanSeed = hTimeValue.tv_usec;
-  CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine);
-  G4cout << "Initialize random numbers with seed = "
-         << m_hRanSeed << G4endl;
-  CLHEP::HepRandom::setTheSeed(m_hRanSeed);
+#endif
+  if ( ! seeded ) {
+    // Only for interactive or test runs: sharded production jobs
+    // should pass --seed so that they can be reproduced
+    struct timeval hTimeValue;
+    gettimeofday(&hTimeValue, NULL);
+    masterSeed = ((unsigned long long) hTimeValue.tv_sec * 1000000ULL
+                  + hTimeValue.tv_usec) ^ ((unsigned long long) getpid() << 40);
+  }
+  SeedShard(masterSeed, shard);
+  G4cout << "Initialize random numbers with master seed = " << masterSeed
+         << ", shard " << shard << "/" << nShards << G4endl;
+
+  // Split the job events over the shards; the first nTotalEvents % nShards
+  // shards take one extra event
+  G4long nEvents = nTotalEvents / nShards
+                   + (shard < nTotalEvents % nShards ? 1 : 0);
+  // Stage two: every shard replays its own slice of the phase space
+  PhaseSpaceSource::SetShard(shard, nShards);
+
   auto actioninitial = new ActionInitialization();
+  actioninitial->SetOutputMode(outputMode);
+  actioninitial->SetShard(shard);
+  actioninitial->SetCheckpointInterval(checkpointInterval);
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
-  if ( (! ui) &&  (argc > 2) )
+  UImanager->ApplyCommand("/control/alias nEvents " + std::to_string(nEvents));
+  if ( checkpointInterval > 0 && outfile.empty() ) outfile = "toy";
+  if ( sharded ) {
+    // outfile is the common base name of all shards, e.g. out/run_0007.root
+    if ( outfile.empty() ) outfile = "toy";
+    G4int width = std::to_string(nShards - 1).size();
+    std::string index = std::to_string(shard);
+    outfile += "_" + std::string(width - index.size(), '0') + index;
+    G4cout << "Shard " << shard << "/" << nShards << " processes " << nEvents
+           << " of " << nTotalEvents << " events into " << outfile << ".root"
+           << G4endl;
+  }
+  if ( ! outfile.empty() )
   {
-    //argv[2] is out file name
-    std::string outfile = argv[2];
-    outfile = outfile + ".root";
-    actioninitial->SetDataFilenamemy(outfile);
+    //outfile is out file name without extension
+    actioninitial->SetDataFilenamemy(outfile + ".root");
   }
   //actioninitial->SetDataFilenamemy("out.root");
+  // Records are named after the output file, or the macro
+  actioninitial->SetBenchmark(benchFile, outfile.empty() ? macro : outfile);
+  actioninitial->SetPhysicsListName(physicsListName);
+
+  // Construct the run manager; in MT mode the master seeds the workers
+  // from the engine set above and shares geometry and physics tables
+  //
+#ifdef G4MULTITHREADED
+  auto runManager = new G4MTRunManager;
+  if ( nThreads <= 0 ) nThreads = G4Threading::G4GetNumberOfCores();
+  runManager->SetNumberOfThreads(nThreads);
+  G4cout << "Running with " << nThreads << " worker threads" << G4endl;
+#else
   G4RunManager* runManager = new G4RunManager;
-  
+  if ( nThreads != 1 ) {
+    G4cout << "Geant4 built without multithreading, -t ignored" << G4endl;
+  }
+#endif
+  StartupTimer::Mark("run manager");
+
   // Detector construction
-  runManager->SetUserInitialization(new DetectorConstruction());
-  // Physics list
-  G4VModularPhysicsList* physicsList = new QBBC;
+  auto detector = new DetectorConstruction();
+  detector->SetGeometryMode(geometryMode);
+  detector->SetGdmlFile(gdmlFile);
+  detector->SetCheckOverlaps(checkOverlaps);
+  runManager->SetUserInitialization(detector);
+  // Physics list; the startup report gives the time and memory of its
+  // construction and of its tables, built at the first run
+  G4VModularPhysicsList* physicsList
+    = G4PhysListFactory().GetReferencePhysList(physicsListName);
   physicsList->SetVerboseLevel(1);
   runManager->SetUserInitialization(physicsList);
+  if ( IsHighPrecision(physicsListName) ) {
+    // The master reads the neutron data when it builds the tables, and
+    // the worker threads use its cross sections and final states
+    G4cout << "Physics list " << physicsListName << ": neutron data read"
+           << " once per process and shared by its worker threads; prefer"
+           << " fewer shards with more threads (-t)" << G4endl;
+  }
+  if ( ! tableDir.empty() ) {
+    PhysicsTableCache::Retrieve(physicsList, physicsListName, tableDir);
+  }
+  // /toy/biasing/ commands, they complete the physics list and detector
+  auto biasing = new ScintillatorBiasing(physicsList, detector);
+  // /toy/region/ commands: cuts and user limits of the detector regions
+  auto regions = new DetectorRegions(physicsList);
+  StartupTimer::Mark("physics list");
+  // /toy/run/beamOn, checkpointed next to the output file
+  auto checkpoint
+    = new CheckpointManager(outfile + ".ckpt", checkpointInterval);
   // User action initialization
   runManager->SetUserInitialization(actioninitial);
+
+  // Build the physics tables of the geometry without events and store
+  // them for the production jobs
+  //
+  if ( ! storeTableDir.empty() ) {
+    runManager->Initialize();
+    runManager->BeamOn(0);
+    StartupTimer::Mark("physics tables");
+    G4bool stored
+      = PhysicsTableCache::Store(physicsList, physicsListName, storeTableDir);
+    delete checkpoint;
+    delete regions;
+    delete biasing;
+    delete runManager;
+    return stored ? 0 : 1;
+  }
+#ifdef TOYMC_BATCH
+  // Straight into the macro
+  //
+  UImanager->ApplyCommand("/control/execute " + macro);
+#else
   // Initialize visualization
   //
   G4VisManager* visManager = new G4VisExecutive;
   // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
   // G4VisManager* visManager = new G4VisExecutive("Quiet");
   visManager->Initialize();
+  StartupTimer::Mark("visualization");
 
   // Get the pointer to the User Interface manager
- 
+
 
   // Process macro or start UI session
   //
-  if ( ! ui ) { 
+  if ( ! ui ) {
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
-  else { 
+  else {
     // interactive mode
     UImanager->ApplyCommand("/control/execute init_vis.mac");
     ui->SessionStart();
     delete ui;
   }
+#endif
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
-  // owned and deleted by the run manager, so they should not be deleted 
+  // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
-  
+
+#ifndef TOYMC_BATCH
   delete visManager;
+#endif
+  delete checkpoint;
+  delete regions;
+  delete biasing;
   delete runManager;
 }
 